@@ -17,15 +17,30 @@
   - Strategic Dormancy (Low Light / Bad Weather)
   - Serial Data Dump capability
   - Evening Lighting Logic (LEDs ON for 4h or until Midnight)
+  - EEPROM Checkpoint (resumes state, LED timer & panel position after a reset)
+  - Soft-Start PWM Motor Drive with Current-Sense Stall/End-of-Travel Cut-Off
+  - LDR Gain/Offset Calibration (serial 'c', stored in EEPROM)
+  - Stack Watermark (serial 's': worst-case free SRAM since reset)
 */
 
 #include <SPI.h>
 #include <SD.h>
 #include <Wire.h>
 #include <RTClib.h> // You may need to install "RTClib" via Library Manager
+#include <EEPROM.h>
+
+// --- HOST BUILD HOOKS ---
+// Empty on the Arduino. The host tuner (tests/tuner.cpp) defines these as
+// thread_local so each simulation thread gets its own copy of the globals.
+#ifndef TRACKER_STATE
+#define TRACKER_STATE
+#endif
+#ifndef TRACKER_PARAM
+#define TRACKER_PARAM const
+#endif
 
 // --- OBJECTS ---
-RTC_DS1307 rtc; // Most shields use DS1307. If yours is newer, try RTC_PCF8523
+TRACKER_STATE RTC_DS1307 rtc; // Most shields use DS1307. If yours is newer, try RTC_PCF8523
 
 // --- STATE MACHINE ---
 enum State {
@@ -37,32 +52,155 @@ enum State {
   STATE_ERROR           
 };
 
-State currentState = STATE_IDLE;
-bool nightModeInitialized = false;
-unsigned long nightEntryTime = 0;
-unsigned long ledStartTime = 0;
+TRACKER_STATE State currentState = STATE_IDLE;
+TRACKER_STATE bool nightModeInitialized = false;
+TRACKER_STATE unsigned long nightEntryTime = 0;
+TRACKER_STATE unsigned long ledStartTime = 0;
+TRACKER_STATE bool ledOn = false;
 
 // --- PIN DEFINITIONS ---
 const int LDR_EAST = A0;
 const int LDR_WEST = A1;
-const int ACT_EXTEND = 9;  
-const int ACT_RETRACT = 8;
+const int ACT_EXTEND = 9;   // PWM (Timer1)
+const int ACT_RETRACT = 8;  // Direction only: pin 8 has no PWM on the UNO
+const int ACT_CURRENT = A2; // Actuator current sense amplifier (0V = no current)
 const int LED_PIN = 7;
 const int CHIP_SELECT = 10; // CS pin for SD card (usually 10 on Shields)
 
 // --- CONFIGURATION ---
-const unsigned long TRACKING_INTERVAL =  600000; // 10 Minutes (ms)
-const int LDR_THRESHOLD = 50;
+TRACKER_PARAM unsigned long TRACKING_INTERVAL =  600000; // 10 Minutes (ms)
+TRACKER_PARAM int LDR_THRESHOLD = 50;
 const int LDR_MIN_VALID = 10;     // Lowered threshold, if < this, suspect broken wire (0)
 const int LDR_MAX_VALID = 1015;   // If > this, suspect short (1023)
-const unsigned long REDUNDANT_MOVE_TIME = 1000; // Time to move West in redundant mode (ms)
+TRACKER_PARAM unsigned long REDUNDANT_MOVE_TIME = 1000; // Time to move West in redundant mode (ms)
+TRACKER_PARAM int LDR_DARK_THRESHOLD = 8;   // Both sensors below this = dark (night/storm)
+TRACKER_PARAM int LDR_WAKE_THRESHOLD = 150; // East above this ends Night Mode
+
+const unsigned long LED_MAX_ON_TIME = 14400000;   // 4 Hours (ms)
+const unsigned long NIGHT_RETRACT_TIME = 30000;   // Full retract to home (ms)
+const long ACTUATOR_TRAVEL_TIME = 30000;          // Home to full extension (ms)
+const unsigned long LOOP_INTERVAL = 1000;         // Main loop pass (ms)
+
+TRACKER_STATE unsigned long lastTrackTime = 0;
+TRACKER_STATE uint32_t lastTrackRtc = 0;          // RTC time of lastTrackTime (0 = never)
+
+// --- ACTUATOR POSITION (dead reckoning) ---
+// Milliseconds of extension from the fully retracted home position
+TRACKER_STATE long actuatorPosition = 0;
+TRACKER_STATE int motorDirection = 0;             // +1 West, -1 East, 0 Stopped
+TRACKER_STATE unsigned long motorStartTime = 0;
+TRACKER_STATE long positionResidue = 0;           // Sub-ms remainder, in ms * duty
+
+// --- MOTOR DRIVE ---
+// Sign-magnitude PWM on the existing pins: D8 selects direction, D9 carries
+// the duty (inverted when D8 is HIGH). Moves ramp up and down instead of
+// hitting the battery with full inrush, and the current sense cuts the drive
+// as soon as the actuator stalls or its end-of-travel switch opens.
+const int MOTOR_DUTY_MAX = 255;
+const unsigned long SOFT_START_TIME = 100;  // Ramp 0 -> full duty (ms)
+const unsigned long SOFT_STOP_TIME = 50;    // Ramp full duty -> 0 (ms)
+const bool CURRENT_SENSE_FITTED = true;     // false: no amplifier on A2 (a floating pin reads noise)
+const int CURRENT_MA_PER_COUNT = 10;        // Sense scale, 10A full scale
+const int CURRENT_STALL = 300;              // ~3A: jammed or pushing an end stop
+const int CURRENT_RUNNING = 10;             // ~0.1A: below this the motor circuit is open
+const unsigned long CURRENT_TRIP_TIME = 10; // Fault must persist this long (ms)
+
+TRACKER_STATE int motorDuty = 0;            // Present duty, 0-255
+TRACKER_STATE bool currentSeen = false;     // Running current seen this move (sense fitted)
+TRACKER_STATE bool tripPending = false;
+TRACKER_STATE unsigned long tripSince = 0;
+
+// --- CHECKPOINT (EEPROM) ---
+// A ring of CRC-protected slots; each save goes to the slot after the newest
+// one so the EEPROM wear is spread across the whole ring.
+struct Checkpoint {
+  uint8_t magic;
+  uint8_t seq;            // Increments per save, newest wins (wraps at 255)
+  uint8_t state;
+  uint8_t flags;          // CP_NIGHT_INIT | CP_LED_ON
+  uint16_t position;      // actuatorPosition (ms)
+  uint16_t ledRemaining;  // LED budget left (s)
+  uint32_t lastTrack;     // lastTrackRtc
+  uint32_t savedAt;       // RTC time of this save
+  uint16_t crc;           // CRC-16/CCITT of all bytes above
+};
+
+const uint8_t CP_MAGIC = 0xA7;
+const uint8_t CP_NIGHT_INIT = 0x01;
+const uint8_t CP_LED_ON = 0x02;
+const int CHECKPOINT_ADDR = 0;
+const int CHECKPOINT_SLOTS = 16;
+const uint32_t CHECKPOINT_MAX_AGE = 3600;          // Older than this (s): re-evaluate from Idle
+const unsigned long CHECKPOINT_HEARTBEAT = 600000; // Re-save unchanged state every 10 Minutes (ms)
+
+TRACKER_STATE Checkpoint lastCheckpoint;
+TRACKER_STATE int checkpointSlot = -1;             // Slot of lastCheckpoint, -1 = none
+TRACKER_STATE unsigned long checkpointMillis = 0;  // millis() of the last save (or restore)
+TRACKER_STATE bool retractPending = false;         // Resumed mid-retraction: drive on the next pass
+
+// --- LDR CALIBRATION (EEPROM) ---
+// Mismatched LDRs and 10k divider tolerances bias East - West. Under uniform
+// light both sensors should read the same, so each one is fitted to their
+// average: calibrated = raw * gain + offset, gain in Q2.14 fixed point.
+struct LdrCalibration {
+  uint8_t magic;
+  int16_t gain[2];        // [0] East, [1] West; CAL_ONE = 1.0
+  int16_t offset[2];      // Counts
+  uint16_t crc;           // CRC-16/CCITT of all bytes above
+};
 
-unsigned long lastTrackTime = 0;
+const uint8_t CAL_MAGIC = 0x5C;
+const int CALIBRATION_ADDR = CHECKPOINT_ADDR + CHECKPOINT_SLOTS * (int)sizeof(Checkpoint);
+const int16_t CAL_ONE = 16384;                     // Q2.14
+const int CAL_SAMPLES = 60;                        // 1 per loop, ~1 Minute
+const int CAL_MIN_LIGHT = 100;                     // Too dark to calibrate below this
+const int CAL_MIN_SPAN = 100;                      // Light range needed to fit the offset too
+const float CAL_GAIN_MIN = 0.5;
+const float CAL_GAIN_MAX = 1.9;
+const int CAL_OFFSET_MAX = 200;
+const int CAL_OFFSET_FLOOR = 100;                  // Offset fades out below this raw level
+
+TRACKER_STATE LdrCalibration ldrCal = { CAL_MAGIC, { CAL_ONE, CAL_ONE }, { 0, 0 }, 0 };
+TRACKER_STATE int calibrationSamples = -1;         // -1 = not calibrating
+// Sums of samples minus the first sample (keeps float precision for the fit)
+TRACKER_STATE int calShift[2], calRef2Shift;
+TRACKER_STATE long calSum[2], calSumSq[2], calSumRef[2], calRef2Sum;
+TRACKER_STATE int calRefMin, calRefMax;
+
+// --- STACK WATERMARK ---
+// Free SRAM between .bss and the stack is painted at reset. The paint the
+// stack has never overwritten, above the heap, is the worst-case headroom
+// left (serial 's').
+const uint8_t STACK_PAINT = 0xC5;
+
+#ifdef __AVR__
+extern uint8_t _end;         // End of .bss
+extern uint8_t __heap_start; // Start of the heap (same as _end)
+extern void* __brkval;       // Top of the heap, 0 until the first malloc
+extern uint8_t __stack;      // Top of SRAM
+
+// Runs from .init1, before the C runtime has set up a stack: basic asm only
+// (0xC5 is STACK_PAINT)
+void paintStack() __attribute__((naked, used, section(".init1")));
+void paintStack() {
+  __asm volatile (
+    "    ldi r30, lo8(_end)\n"
+    "    ldi r31, hi8(_end)\n"
+    "    ldi r24, 0xC5\n"
+    "    ldi r25, hi8(__stack)\n"
+    "    rjmp 2f\n"
+    "1:  st Z+, r24\n"
+    "2:  cpi r30, lo8(__stack)\n"
+    "    cpc r31, r25\n"
+    "    brlo 1b\n"
+    "    breq 1b\n");
+}
+#endif
 
 // --- FUNCTION PROTOTYPES ---
 void checkSerialCommand();
 void dumpDataLog();
-void logData(const char* mode, int e, int w, int d);
+void logData(const __FlashStringHelper* mode, int e, int w, int d);
 void runIdleState();
 void runTrackingState();
 void runNightResetState();
@@ -73,6 +211,25 @@ bool isSensorOperational();
 void moveWest();
 void moveEast();
 void stopMotor();
+void updateActuatorPosition();
+void setMotorDrive(int direction, int duty);
+bool rampMotor(int direction, int toDuty, unsigned long fullRampTime);
+bool checkMotorCurrent();
+bool actuatorDelay(unsigned long ms);
+bool driveActuator(int direction, unsigned long ms);
+void setLed(bool on);
+uint16_t crc16(const uint8_t* data, size_t len);
+bool readCheckpoint(int slot, Checkpoint& cp);
+void restoreCheckpoint();
+void saveCheckpoint();
+int readLDR(int pin);
+int calibrateLDR(int idx, int raw);
+void loadCalibration();
+void startCalibration();
+void sampleCalibration();
+void finishCalibration();
+size_t unusedStack(const uint8_t* bottom, const uint8_t* top);
+void reportStack();
 
 void setup() {
   Serial.begin(9600);
@@ -94,7 +251,11 @@ void setup() {
     rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
   }
 
-  // 3. SD CARD SETUP - Crucial Order Change
+  // 3. RESUME FROM CHECKPOINT (brownout/reset) + SENSOR CALIBRATION
+  restoreCheckpoint();
+  loadCalibration();
+
+  // 4. SD CARD SETUP - Crucial Order Change
   Serial.print(F("Initializing SD card..."));
   
   if (!SD.begin(CHIP_SELECT)) { // We must call begin() first
@@ -110,10 +271,10 @@ void setup() {
         headerFile.close();
       }
     }
-    logData("System Start", 0, 0, 0); 
+    logData(F("System Start"), 0, 0, 0); 
   }
 
-  // 4. SEASON CHECK - Disabled for Testing
+  // 5. SEASON CHECK - Disabled for Testing
   DateTime now = rtc.now();
   int currentMonth = now.month();
   
@@ -132,14 +293,22 @@ void loop() {
     int debugEast = analogRead(A0); // Read the East sensor
     int debugWest = analogRead(A1); // Read the West sensor
 
-    Serial.print("East Sensor: ");
+    Serial.print(F("East Sensor: "));
     Serial.print(debugEast);
-    Serial.print(" | West Sensor: ");
+    Serial.print(F(" | West Sensor: "));
     Serial.println(debugWest);
-
-    delay(1000); // Wait 1 second so the screen doesn't scroll too fast
     // --- SENSOR DEBUG END ---
 
+  // One pass per second. The night retraction runs across passes, so this
+  // wait is where its current is watched for a stall or end of travel.
+  actuatorDelay(LOOP_INTERVAL);
+
+  // Calibration holds the state machine (and the panel) still until done
+  if (calibrationSamples >= 0) {
+    sampleCalibration();
+    return;
+  }
+
   switch (currentState) {
     case STATE_IDLE:
       runIdleState();
@@ -160,6 +329,8 @@ void loop() {
       runErrorState();
       break;
   }
+
+  saveCheckpoint();
 }
 
 // --- LOGIC FUNCTIONS ---
@@ -169,11 +340,11 @@ void runIdleState() {
   
   // 1. Check for Night Time (Reset Condition)
   // Simple check: if both sensors are dark
-  int east = analogRead(LDR_EAST);
-  int west = analogRead(LDR_WEST);
+  int east = readLDR(LDR_EAST);
+  int west = readLDR(LDR_WEST);
   
   // Note: 100 is a baseline threshold for darkness as per user requirement.
-  if (east < 8 && west < 8) { // Changed from 100 to 8 per user request
+  if (east < LDR_DARK_THRESHOLD && west < LDR_DARK_THRESHOLD) { // Changed from 100 to 8 per user request
     // Confirm it's actually evening (past 16:00) to avoid storm triggering reset
     if (now.hour() > 16) {
         currentState = STATE_NIGHT_RESET;
@@ -200,12 +371,12 @@ void runIdleState() {
 }
 
 void runTrackingState() {
-  int east = analogRead(LDR_EAST);
-  int west = analogRead(LDR_WEST);
+  int east = readLDR(LDR_EAST);
+  int west = readLDR(LDR_WEST);
   int diff = east - west;
   
   // Log the attempt
-  logData("TRACKING", east, west, diff);
+  logData(F("TRACKING"), east, west, diff);
 
   if (!isSensorOperational()) {
       stopMotor();
@@ -216,17 +387,17 @@ void runTrackingState() {
   if (abs(diff) <= LDR_THRESHOLD) {
     stopMotor();
     lastTrackTime = millis();
+    lastTrackRtc = rtc.now().unixtime();
     currentState = STATE_IDLE;
   } 
-  else if (diff > LDR_THRESHOLD) {
-    moveWest();
-    delay(500); // Move a bit
-    stopMotor(); // Stop to re-measure
-  } 
-  else if (diff < -LDR_THRESHOLD) {
-    moveEast();
-    delay(500);
-    stopMotor();
+  else if (diff > LDR_THRESHOLD || diff < -LDR_THRESHOLD) {
+    // Move a bit, then stop to re-measure
+    if (!driveActuator(diff > 0 ? 1 : -1, 500)) {
+      // Jammed or at end of travel: give up until the next interval
+      lastTrackTime = millis();
+      lastTrackRtc = rtc.now().unixtime();
+      currentState = STATE_IDLE;
+    }
   }
 }
 
@@ -239,7 +410,7 @@ void runDormancyState() {
   // 1. Winter Check
   //if (now.month() >= 3 && now.month() <= 10) {
     // It's not Winter. Is it still dark?
-    int east = analogRead(LDR_EAST);
+    int east = readLDR(LDR_EAST);
     if (east > 200) { // Arbitrary "Light" threshold
         Serial.println(F("Conditions improved. Waking up."));
         currentState = STATE_IDLE;
@@ -249,7 +420,7 @@ void runDormancyState() {
 
   // Log occasionally
   if (now.minute() == 0 && now.second() == 0) {
-       logData("DORMANT", 0, 0, 0);
+       logData(F("DORMANT"), 0, 0, 0);
        delay(1000); 
   }
 }
@@ -257,14 +428,13 @@ void runDormancyState() {
 void runRedundantState() {
   // Dead Reckoning: Move West a fixed amount every interval
   if (millis() - lastTrackTime > TRACKING_INTERVAL) {
-      logData("REDUNDANT_MOVE", 0, 0, 0);
-      moveWest();
-      delay(REDUNDANT_MOVE_TIME);
-      stopMotor();
+      logData(F("REDUNDANT_MOVE"), 0, 0, 0);
+      driveActuator(1, REDUNDANT_MOVE_TIME);
       lastTrackTime = millis();
       
       // Check if night (by time, since sensors are dead)
       DateTime now = rtc.now();
+      lastTrackRtc = now.unixtime();
       if (now.hour() >= 20) {
           currentState = STATE_NIGHT_RESET;
           nightModeInitialized = false;
@@ -277,10 +447,10 @@ void runNightResetState() {
 
   // Initialization Phase
   if (!nightModeInitialized) {
-      logData("NIGHT_RESET_INIT", 0, 0, 0);
+      logData(F("NIGHT_RESET_INIT"), 0, 0, 0);
 
       // Turn on LEDs
-      digitalWrite(LED_PIN, HIGH);
+      setLed(true);
       ledStartTime = millis(); // Record LED ON time
 
       // Start Retracting (Move East)
@@ -290,9 +460,18 @@ void runNightResetState() {
       nightModeInitialized = true;
   }
 
+  // Resumed from a checkpoint mid-retraction: drive the rest of the way
+  if (retractPending) {
+      retractPending = false;
+      unsigned long toGo = (unsigned long)actuatorPosition;
+      if (toGo > NIGHT_RETRACT_TIME) toGo = NIGHT_RETRACT_TIME;
+      nightEntryTime = millis() - (NIGHT_RETRACT_TIME - toGo);
+      moveEast();
+  }
+
   // Retraction Phase
   // Retract for 30 seconds
-  if (millis() - nightEntryTime < 30000) {
+  if (millis() - nightEntryTime < NIGHT_RETRACT_TIME) {
       // Still retracting, do nothing (motor is already moving East)
   } else {
       stopMotor(); // Done retracting
@@ -301,21 +480,21 @@ void runNightResetState() {
   // LED Logic Phase
   // Check Duration Limit (4 hours = 14400000 ms)
   // Check Midnight Limit (hour == 0)
-  bool timeLimitReached = (millis() - ledStartTime > 14400000);
+  bool timeLimitReached = (millis() - ledStartTime > LED_MAX_ON_TIME);
   bool midnightReached = (now.hour() == 0);
 
   if (timeLimitReached || midnightReached) {
-      digitalWrite(LED_PIN, LOW);
+      setLed(false);
   }
 
   // Morning Check Phase
-  int east = analogRead(LDR_EAST);
+  int east = readLDR(LDR_EAST);
   
   // Wake on Light (> 150) OR Time (7 AM)
-  if (east > 150 || (now.hour() == 7 && now.minute() == 0)) {
-       digitalWrite(LED_PIN, LOW); // Ensure LEDs off
+  if (east > LDR_WAKE_THRESHOLD || (now.hour() == 7 && now.minute() == 0)) {
+       setLed(false); // Ensure LEDs off
        currentState = STATE_IDLE;
-       logData("WAKE_UP", east, 0, 0);
+       logData(F("WAKE_UP"), east, 0, 0);
   }
 }
 
@@ -328,10 +507,10 @@ void runErrorState() {
 // --- HELPER FUNCTIONS ---
 
 bool isSensorOperational() {
-   int e = analogRead(LDR_EAST);
-   int w = analogRead(LDR_WEST);
+   int e = readLDR(LDR_EAST);
+   int w = readLDR(LDR_WEST);
    
-   // Check for disconnected/shorted wires
+   // Check for disconnected/shorted wires (calibration passes the rails through)
    if (e < LDR_MIN_VALID || e > LDR_MAX_VALID) return false;
    if (w < LDR_MIN_VALID || w > LDR_MAX_VALID) return false;
    
@@ -350,17 +529,24 @@ void checkSerialCommand() {
         // Press 'w' to move West for 2 seconds
         if (c == 'w' || c == 'W') {
             Serial.println(F("Manual Move: West"));
-            moveWest();
-            delay(2000);
-            stopMotor();
+            driveActuator(1, 2000);
         }
 
         // Press 'e' to move East for 2 seconds
         if (c == 'e' || c == 'E') {
             Serial.println(F("Manual Move: East"));
-            moveEast();
-            delay(2000);
-            stopMotor();
+            driveActuator(-1, 2000);
+        }
+
+        // Press 'c' to calibrate the LDRs (cover both with the same diffuser,
+        // or use an evenly overcast sky; varying light also fits the offset)
+        if (c == 'c' || c == 'C') {
+            startCalibration();
+        }
+
+        // Press 's' for the stack headroom left since reset
+        if (c == 's' || c == 'S') {
+            reportStack();
         }
     }
 }
@@ -384,7 +570,7 @@ void dumpDataLog() {
     Serial.println(F("\n--- DATA DUMP END ---"));
 }
 
-void logData(const char* mode, int e, int w, int d) {
+void logData(const __FlashStringHelper* mode, int e, int w, int d) {
   // Format: Date, Time, Mode, East, West, Diff
   DateTime now = rtc.now();
   
@@ -416,17 +602,396 @@ void logData(const char* mode, int e, int w, int d) {
   }
 }
 
+// Soft-start and leave running (caller stops it)
 void moveWest() {
-  digitalWrite(ACT_EXTEND, HIGH);
-  digitalWrite(ACT_RETRACT, LOW);
+  if (motorDirection < 0) stopMotor();
+  rampMotor(1, MOTOR_DUTY_MAX, SOFT_START_TIME);
 }
 
 void moveEast() {
-  digitalWrite(ACT_EXTEND, LOW);
-  digitalWrite(ACT_RETRACT, HIGH);
+  if (motorDirection > 0) stopMotor();
+  rampMotor(-1, MOTOR_DUTY_MAX, SOFT_START_TIME);
 }
 
+// Soft-stop
 void stopMotor() {
-  digitalWrite(ACT_EXTEND, LOW);
-  digitalWrite(ACT_RETRACT, LOW);
+  if (motorDirection != 0) rampMotor(motorDirection, 0, SOFT_STOP_TIME);
+  setMotorDrive(0, 0);
+}
+
+// Blocking move: ramp up, hold for ms while watching current, ramp down.
+// Returns false if the current sense cut the move short.
+bool driveActuator(int direction, unsigned long ms) {
+  if (direction > 0) moveWest(); else moveEast();
+  if (motorDirection == 0 || !actuatorDelay(ms)) return false;
+  stopMotor();
+  return true;
+}
+
+void setMotorDrive(int direction, int duty) {
+  updateActuatorPosition();
+  if (direction != motorDirection) {
+    currentSeen = false;
+    tripPending = false;
+  }
+  motorDirection = (duty > 0) ? direction : 0;
+  motorDuty = (duty > 0) ? duty : 0;
+
+  if (direction > 0) {
+    digitalWrite(ACT_RETRACT, LOW);
+    analogWrite(ACT_EXTEND, motorDuty);
+  } else if (direction < 0) {
+    digitalWrite(ACT_RETRACT, HIGH);
+    analogWrite(ACT_EXTEND, MOTOR_DUTY_MAX - motorDuty);
+  } else {
+    digitalWrite(ACT_EXTEND, LOW);
+    digitalWrite(ACT_RETRACT, LOW);
+  }
+}
+
+// Step the duty 1ms at a time towards toDuty (a 0 -> 255 ramp takes
+// fullRampTime). Returns false if the current sense tripped on the way.
+bool rampMotor(int direction, int toDuty, unsigned long fullRampTime) {
+  int from = (direction == motorDirection) ? motorDuty : 0;
+  int span = toDuty - from;
+  unsigned long steps = fullRampTime * (unsigned long)abs(span) / MOTOR_DUTY_MAX;
+  for (unsigned long i = 1; i <= steps; i++) {
+    setMotorDrive(direction, from + (int)((long)span * (long)i / (long)steps));
+    delay(1);
+    if (toDuty > 0 && !checkMotorCurrent()) return false;
+  }
+  setMotorDrive(direction, toDuty);
+  return true;
+}
+
+// Sample the actuator current; cut the drive (no ramp) on a stall or when
+// the end-of-travel switch opens. Returns false once tripped.
+bool checkMotorCurrent() {
+  if (motorDirection == 0) return false;
+  if (!CURRENT_SENSE_FITTED) return true; // Soft start/stop only
+
+  int sense = analogRead(ACT_CURRENT);
+  if (sense >= CURRENT_RUNNING) currentSeen = true;
+
+  bool stalled = sense >= CURRENT_STALL;
+  bool openCircuit = currentSeen && sense < CURRENT_RUNNING; // Not fitted = never seen
+  if (!stalled && !openCircuit) {
+    tripPending = false;
+    return true;
+  }
+  if (!tripPending) {
+    tripPending = true;
+    tripSince = millis();
+    return true;
+  }
+  if (millis() - tripSince < CURRENT_TRIP_TIME) return true;
+
+  int direction = motorDirection;
+  setMotorDrive(0, 0);
+
+  // An open switch, or a stall near the end we think we are at, is the end stop:
+  // free re-homing of the position estimate
+  const long nearEnd = ACTUATOR_TRAVEL_TIME / 10;
+  if (direction < 0 && (openCircuit || actuatorPosition < nearEnd)) {
+    actuatorPosition = 0;
+    logData(F("END_OF_TRAVEL"), sense * CURRENT_MA_PER_COUNT, 0, direction);
+  } else if (direction > 0 && (openCircuit || actuatorPosition > ACTUATOR_TRAVEL_TIME - nearEnd)) {
+    actuatorPosition = ACTUATOR_TRAVEL_TIME;
+    logData(F("END_OF_TRAVEL"), sense * CURRENT_MA_PER_COUNT, 0, direction);
+  } else {
+    Serial.println(F("MOTOR FAULT: Actuator stalled"));
+    logData(F("MOTOR_STALL"), sense * CURRENT_MA_PER_COUNT, 0, direction);
+  }
+  return false;
+}
+
+// delay() that keeps sampling the actuator current every 1ms while it runs.
+// Returns false (early) if the drive was cut.
+bool actuatorDelay(unsigned long ms) {
+  if (motorDirection == 0) {
+    delay(ms);
+    return true;
+  }
+  for (unsigned long i = 0; i < ms; i++) {
+    delay(1);
+    if (!checkMotorCurrent()) return false;
+  }
+  return true;
+}
+
+// Credit the time driven since the last call to the position estimate,
+// scaled by the duty so ramps count for what they actually moved
+void updateActuatorPosition() {
+  unsigned long now = millis();
+  positionResidue += motorDirection * (long)(now - motorStartTime) * motorDuty;
+  actuatorPosition += positionResidue / MOTOR_DUTY_MAX;
+  positionResidue %= MOTOR_DUTY_MAX;
+  if (actuatorPosition < 0) { actuatorPosition = 0; positionResidue = 0; }  // Home (end stop)
+  if (actuatorPosition > ACTUATOR_TRAVEL_TIME) { actuatorPosition = ACTUATOR_TRAVEL_TIME; positionResidue = 0; }
+  motorStartTime = now;
+}
+
+void setLed(bool on) {
+  ledOn = on;
+  digitalWrite(LED_PIN, on ? HIGH : LOW);
+}
+
+// --- SENSOR CALIBRATION FUNCTIONS ---
+
+// Calibrated LDR reading: the only place the state machine reads the LDRs
+int readLDR(int pin) {
+  return calibrateLDR(pin == LDR_WEST ? 1 : 0, analogRead(pin));
+}
+
+int calibrateLDR(int idx, int raw) {
+  // Rails mean a broken or shorted wire, not light: keep them for the health check
+  if (raw <= 0 || raw >= 1023) return raw;
+  // The offset is fitted in daylight. In the dark both dividers read ~0
+  // whatever their mismatch, so fade it out there: otherwise dusk never
+  // reads dark (positive offset) or looks like a broken wire (negative).
+  long offset = ldrCal.offset[idx];
+  if (raw < CAL_OFFSET_FLOOR) offset = offset * raw / CAL_OFFSET_FLOOR;
+  long v = (((long)raw * ldrCal.gain[idx] + CAL_ONE / 2) >> 14) + offset;
+  if (v < 1) v = 1;
+  if (v > 1022) v = 1022;
+  return (int)v;
+}
+
+void loadCalibration() {
+  LdrCalibration cal;
+  EEPROM.get(CALIBRATION_ADDR, cal);
+  if (cal.magic == CAL_MAGIC &&
+      cal.crc == crc16((const uint8_t*)&cal, offsetof(LdrCalibration, crc))) {
+    ldrCal = cal;
+    Serial.println(F("LDR calibration loaded."));
+  }
+}
+
+void startCalibration() {
+  stopMotor();
+  calibrationSamples = 0;
+  for (int i = 0; i < 2; i++) {
+    calSum[i] = 0;
+    calSumSq[i] = 0;
+    calSumRef[i] = 0;
+  }
+  calRef2Sum = 0;
+  calRefMin = 1023;
+  calRefMax = 0;
+  Serial.println(F("LDR calibration: sampling, keep light uniform..."));
+}
+
+void sampleCalibration() {
+  int raw[2] = { analogRead(LDR_EAST), analogRead(LDR_WEST) };
+  if (raw[0] < LDR_MIN_VALID || raw[0] > LDR_MAX_VALID ||
+      raw[1] < LDR_MIN_VALID || raw[1] > LDR_MAX_VALID) {
+    Serial.println(F("LDR calibration aborted: sensor fault."));
+    calibrationSamples = -1;
+    return;
+  }
+  // Target is the mean of both (kept doubled to stay in integers)
+  int ref2 = raw[0] + raw[1];
+  if (calibrationSamples == 0) {
+    calShift[0] = raw[0];
+    calShift[1] = raw[1];
+    calRef2Shift = ref2;
+  }
+  int dr = ref2 - calRef2Shift;
+  for (int i = 0; i < 2; i++) {
+    int dx = raw[i] - calShift[i];
+    calSum[i] += dx;
+    calSumSq[i] += (long)dx * dx;
+    calSumRef[i] += (long)dx * dr;
+  }
+  calRef2Sum += dr;
+  if (ref2 / 2 < calRefMin) calRefMin = ref2 / 2;
+  if (ref2 / 2 > calRefMax) calRefMax = ref2 / 2;
+
+  if (++calibrationSamples >= CAL_SAMPLES) finishCalibration();
+}
+
+// Least-squares fit of each sensor to the mean; gain only if the light
+// barely changed during sampling. Runs once, so float is fine here.
+void finishCalibration() {
+  calibrationSamples = -1;
+  float n = CAL_SAMPLES;
+  float meanRef = (calRef2Shift + calRef2Sum / n) / 2.0;
+  if (meanRef < CAL_MIN_LIGHT) {
+    Serial.println(F("LDR calibration failed: too dark."));
+    return;
+  }
+
+  LdrCalibration cal = {};
+  cal.magic = CAL_MAGIC;
+  for (int i = 0; i < 2; i++) {
+    float sx = calSum[i];
+    float meanX = calShift[i] + sx / n;
+    float gain = meanRef / meanX;
+    float offset = 0;
+    float det = n * calSumSq[i] - sx * sx;
+    if (calRefMax - calRefMin >= CAL_MIN_SPAN && det > 0) {
+      gain = (n * calSumRef[i] - sx * calRef2Sum) / det / 2.0;
+      offset = meanRef - gain * meanX;
+    }
+    if (gain < CAL_GAIN_MIN || gain > CAL_GAIN_MAX || offset < -CAL_OFFSET_MAX || offset > CAL_OFFSET_MAX) {
+      Serial.println(F("LDR calibration failed: sensors out of range."));
+      return;
+    }
+    cal.gain[i] = (int16_t)(gain * CAL_ONE + 0.5);
+    cal.offset[i] = (int16_t)(offset + (offset < 0 ? -0.5 : 0.5));
+  }
+  cal.crc = crc16((const uint8_t*)&cal, offsetof(LdrCalibration, crc));
+  EEPROM.put(CALIBRATION_ADDR, cal);
+  ldrCal = cal;
+
+  Serial.print(F("LDR calibration saved. Gain E/W (x1000): "));
+  Serial.print((int)((long)cal.gain[0] * 1000 / CAL_ONE));
+  Serial.print(F(" / "));
+  Serial.print((int)((long)cal.gain[1] * 1000 / CAL_ONE));
+  Serial.print(F(" Offset E/W: "));
+  Serial.print(cal.offset[0]);
+  Serial.print(F(" / "));
+  Serial.println(cal.offset[1]);
+  logData(F("CALIBRATED"), (int)((long)cal.gain[0] * 1000 / CAL_ONE),
+          (int)((long)cal.gain[1] * 1000 / CAL_ONE), cal.offset[1] - cal.offset[0]);
+}
+
+// --- STACK WATERMARK FUNCTIONS ---
+
+// Painted bytes from bottom up: memory the stack has never reached
+size_t unusedStack(const uint8_t* bottom, const uint8_t* top) {
+  const uint8_t* p = bottom;
+  while (p < top && *p == STACK_PAINT) p++;
+  return (size_t)(p - bottom);
+}
+
+void reportStack() {
+#ifdef __AVR__
+  // Each open SD File mallocs its SdFile: the heap has used the bottom of
+  // the painted area, so the scan starts at its top
+  const uint8_t* heapTop = __brkval ? (const uint8_t*)__brkval : &__heap_start;
+  Serial.print(F("Stack headroom: "));
+  Serial.print((int)unusedStack(heapTop, &__stack));
+  Serial.println(F(" bytes"));
+#else
+  Serial.println(F("Stack headroom: AVR only (host: tests/test_stack.cpp)"));
+#endif
+}
+
+// --- CHECKPOINT FUNCTIONS ---
+
+uint16_t crc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+bool readCheckpoint(int slot, Checkpoint& cp) {
+  EEPROM.get(CHECKPOINT_ADDR + slot * (int)sizeof(Checkpoint), cp);
+  if (cp.magic != CP_MAGIC || cp.state > STATE_ERROR) return false;
+  return cp.crc == crc16((const uint8_t*)&cp, offsetof(Checkpoint, crc));
+}
+
+void restoreCheckpoint() {
+  // Find the newest valid slot (seq distance handles the 255 -> 0 wrap)
+  Checkpoint cp;
+  for (int i = 0; i < CHECKPOINT_SLOTS; i++) {
+    if (!readCheckpoint(i, cp)) continue;
+    if (checkpointSlot < 0 || (int8_t)(cp.seq - lastCheckpoint.seq) > 0) {
+      lastCheckpoint = cp;
+      checkpointSlot = i;
+    }
+  }
+  if (checkpointSlot < 0) {
+    Serial.println(F("No checkpoint, cold start."));
+    return;
+  }
+  cp = lastCheckpoint;
+  checkpointMillis = millis();
+
+  // Position survives any outage: the actuator cannot move without power
+  actuatorPosition = cp.position;
+  if (currentState == STATE_ERROR) return;
+
+  // savedAt is refreshed by the heartbeat, so this is roughly the outage.
+  // A clock behind the save (RTC lost power, reset to compile time) tells
+  // us nothing about the outage: treat it as stale.
+  uint32_t now = rtc.now().unixtime();
+  uint32_t age = (now >= cp.savedAt) ? now - cp.savedAt : CHECKPOINT_MAX_AGE + 1;
+  unsigned long ms = millis();
+
+  // Compare in seconds: the gap in ms overflows after ~49 days
+  if (cp.lastTrack != 0 && now >= cp.lastTrack &&
+      now - cp.lastTrack <= TRACKING_INTERVAL / 1000UL) {
+    lastTrackTime = ms - (now - cp.lastTrack) * 1000UL;
+    lastTrackRtc = cp.lastTrack;
+  } else {
+    lastTrackTime = ms - TRACKING_INTERVAL - 1; // Overdue: track on the next Idle pass
+  }
+
+  if (age > CHECKPOINT_MAX_AGE || cp.state == STATE_ERROR) {
+    Serial.println(F("Checkpoint stale, re-evaluating from Idle."));
+    return;
+  }
+
+  currentState = (State)cp.state;
+  nightModeInitialized = (cp.flags & CP_NIGHT_INIT) != 0;
+
+  if ((cp.flags & CP_LED_ON) && cp.ledRemaining > age) {
+    ledStartTime = ms - (LED_MAX_ON_TIME - (cp.ledRemaining - age) * 1000UL);
+    setLed(true);
+  }
+
+  if (currentState == STATE_NIGHT_RESET && nightModeInitialized) {
+    // Finish any retraction the reset interrupted, no need to re-home.
+    // The drive starts on the first loop() pass, where its current is
+    // watched, not here with the SD card still to initialise.
+    nightEntryTime = ms - NIGHT_RETRACT_TIME;
+    retractPending = actuatorPosition > 0;
+  }
+
+  Serial.print(F("Checkpoint restored, state "));
+  Serial.println((int)currentState);
+}
+
+// Called every loop; only touches EEPROM when something worth keeping changed,
+// or on the heartbeat so savedAt tracks when the tracker was last running
+// (16 slots at one save per 10 minutes: each byte sees ~9 writes a day)
+void saveCheckpoint() {
+  updateActuatorPosition();
+
+  Checkpoint cp = {};
+  cp.magic = CP_MAGIC;
+  cp.state = (uint8_t)currentState;
+  cp.flags = (nightModeInitialized ? CP_NIGHT_INIT : 0) | (ledOn ? CP_LED_ON : 0);
+  cp.position = (uint16_t)actuatorPosition;
+  cp.ledRemaining = 0;
+  if (ledOn) {
+    unsigned long used = millis() - ledStartTime;
+    cp.ledRemaining = (used < LED_MAX_ON_TIME) ? (LED_MAX_ON_TIME - used) / 1000UL : 0;
+  }
+  cp.lastTrack = lastTrackRtc;
+
+  if (checkpointSlot >= 0 &&
+      cp.state == lastCheckpoint.state &&
+      cp.flags == lastCheckpoint.flags &&
+      cp.position == lastCheckpoint.position &&
+      cp.lastTrack == lastCheckpoint.lastTrack &&
+      millis() - checkpointMillis < CHECKPOINT_HEARTBEAT) {
+    return;
+  }
+
+  cp.savedAt = rtc.now().unixtime();
+  cp.seq = (checkpointSlot >= 0) ? lastCheckpoint.seq + 1 : 0;
+  cp.crc = crc16((const uint8_t*)&cp, offsetof(Checkpoint, crc));
+
+  checkpointSlot = (checkpointSlot + 1) % CHECKPOINT_SLOTS;
+  EEPROM.put(CHECKPOINT_ADDR + checkpointSlot * (int)sizeof(Checkpoint), cp);
+  lastCheckpoint = cp;
+  checkpointMillis = millis();
 }
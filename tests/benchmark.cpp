@@ -4,13 +4,14 @@
 
 // Include mocks
 #include "Arduino.h"
+#include "Actuator.h"
 #include "SD.h"
 #include "RTClib.h"
 #include "SPI.h"
 #include "Wire.h"
 
 // Define global mock objects
-SDClass SD;
+MOCK_TLS SDClass SD;
 
 // Forward declarations for functions in main.cpp (required because they are not declared in main.cpp before use, relying on Arduino IDE)
 void checkSerialCommand();
@@ -25,25 +26,60 @@ void stopMotor();
 void moveWest();
 void moveEast();
 void dumpDataLog();
-void logData(const char* mode, int e, int w, int d);
+void logData(const __FlashStringHelper* mode, int e, int w, int d);
 
 // Include the application code
 // We define a macro to prevent duplicate main if we were linking, but here we include cpp.
 #include "../../main.cpp"
 
+// Old drive: H-bridge pins straight to full voltage for the whole pulse
+void oldMove(unsigned long ms) {
+    digitalWrite(ACT_EXTEND, HIGH);
+    digitalWrite(ACT_RETRACT, LOW);
+    delay(ms);
+    digitalWrite(ACT_EXTEND, LOW);
+    digitalWrite(ACT_RETRACT, LOW);
+}
+
+void newMove(unsigned long ms) {
+    driveActuator(1, ms);
+}
+
+void measureMove(const char* name, void (*move)(unsigned long), double jamAt) {
+    ActuatorModel& act = mock_actuator_attach();
+    act.position = 10000;
+    act.jamAt = jamAt;
+    actuatorPosition = 10000;
+    motorDirection = 0;
+    motorDuty = 0;
+    move(500);
+    delay(300); // Let it coast to rest
+    mock_actuator_detach();
+
+    double travel = act.position - 10000;
+    std::cout << "  " << name << ": " << act.energyJ << " J, peak " << act.peakCurrent << " A, travel "
+              << travel << " ms";
+    if (travel > 0) std::cout << ", " << act.energyJ / (travel / 1000.0) << " J per s of travel";
+    std::cout << std::endl;
+}
+
 int main() {
     std::cout << "Starting Benchmark..." << std::endl;
 
     // Initialize mock environment
     // rtc and dataFile are global in main.cpp, so they are instantiated.
 
-    // Benchmark logData
-    const int ITERATIONS = 1000000;
+    // Benchmark logData: host time, and the card I/O each row costs on the AVR
+    const int ITERATIONS = 100000;
+    SD.format();
+    setup();
+    SdStats before = SD.stats;
+    double simStart = SD.simulatedMs();
 
     auto start = std::chrono::high_resolution_clock::now();
 
     for (int i = 0; i < ITERATIONS; i++) {
-        logData("TRACKING", 500, 400, 100);
+        logData(F("TRACKING"), 500, 400, 100);
     }
 
     auto end = std::chrono::high_resolution_clock::now();
@@ -51,6 +87,31 @@ int main() {
 
     std::cout << "Time: " << elapsed.count() << " seconds" << std::endl;
     std::cout << "Average: " << (elapsed.count() / ITERATIONS) * 1e6 << " us/call" << std::endl;
+    std::cout << "SD I/O per logData row (" << SD.timing.spiCyclesPerByte << " cycles/SPI byte):" << std::endl;
+    std::cout << "  Block reads: " << double(SD.stats.sectorReads - before.sectorReads) / ITERATIONS
+              << ", block writes: " << double(SD.stats.sectorWrites - before.sectorWrites) / ITERATIONS
+              << " (directory " << double(SD.stats.dirUpdates - before.dirUpdates) / ITERATIONS
+              << ", FAT " << double(SD.stats.fatUpdates - before.fatUpdates) / ITERATIONS << ")" << std::endl;
+    std::cout << "  Clusters allocated: " << SD.stats.clustersAllocated - before.clustersAllocated
+              << ", simulated time: " << (SD.simulatedMs() - simStart) / ITERATIONS << " ms/row" << std::endl;
+
+    // Serial 'd': read the whole log back
+    size_t logSize = SD.contents("datalog.csv").size();
+    before = SD.stats;
+    simStart = SD.simulatedMs();
+    dumpDataLog();
+    std::cout << "dumpDataLog of " << logSize << " bytes:" << std::endl;
+    std::cout << "  Bytes read: " << SD.stats.bytesRead - before.bytesRead
+              << ", block reads: " << SD.stats.sectorReads - before.sectorReads
+              << ", simulated time: " << (SD.simulatedMs() - simStart) / 1000.0 << " s" << std::endl;
+
+    // Energy per 500ms tracking pulse from the 12V battery (actuator model)
+    std::cout << "Energy per tracking move (500ms pulse):" << std::endl;
+    measureMove("Old drive", oldMove, -1);
+    measureMove("Soft start", newMove, -1);
+    std::cout << "Energy per move into a jammed actuator:" << std::endl;
+    measureMove("Old drive", oldMove, 10050);
+    measureMove("Soft start + stall cut", newMove, 10050);
 
     return 0;
 }
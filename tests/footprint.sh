@@ -0,0 +1,260 @@
+#!/usr/bin/env bash
+# Flash and SRAM footprint of main.cpp, built for the AVR with the real toolchain.
+#
+# Usage: tests/footprint.sh [FQBN]          (default arduino:avr:uno)
+#
+# Needs arduino-cli with the arduino:avr core and the SD and RTClib libraries
+# installed; after that it runs offline. LTO is turned off so every byte can
+# be traced to the object it came from (the IDE's LTO build is a little smaller).
+#
+# Reports flash, .data and .bss per module (main.cpp, each library, the Arduino
+# core, avr-libc/libgcc), the largest symbols, and the peak stack: the deepest
+# static call chain from main() plus the deepest interrupt handler. Frame sizes
+# come from -fstack-usage and the call graph from the disassembly; an indirect
+# call (virtual Print/Stream method) is taken to reach the deepest
+# write/read/peek/available/flush.
+#
+# Exits 1 when a budget is exceeded. Budgets in bytes, from the environment:
+#   FLASH_BUDGET  .text + .data initialisers        default 32256 (UNO less bootloader)
+#   RAM_BUDGET    .data + .bss + heap + peak stack  default 1792  (2 KB less 256 headroom)
+#   STACK_BUDGET  peak stack                        default 512
+#
+# The heap can't be sized statically. When malloc is linked in, HEAP_RESERVE
+# (default 64) is counted instead: each open SD File mallocs a ~29 byte
+# SdFile plus a 2 byte header, and the firmware holds one at a time.
+
+set -euo pipefail
+
+FQBN=${1:-arduino:avr:uno}
+FLASH_BUDGET=${FLASH_BUDGET:-32256}
+RAM_BUDGET=${RAM_BUDGET:-1792}
+STACK_BUDGET=${STACK_BUDGET:-512}
+HEAP_RESERVE=${HEAP_RESERVE:-64}
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if ! command -v arduino-cli >/dev/null; then
+    echo "footprint: arduino-cli not found" >&2
+    exit 2
+fi
+
+# --- BUILD ---
+SKETCH=$WORK/tracker
+BUILD=$WORK/build
+mkdir -p "$SKETCH"
+cp "$ROOT/main.cpp" "$SKETCH/main.cpp"
+echo "// Firmware is in main.cpp" > "$SKETCH/tracker.ino"
+
+if ! arduino-cli compile --clean --fqbn "$FQBN" --build-path "$BUILD" \
+        --build-property "compiler.c.extra_flags=-fno-lto -fstack-usage" \
+        --build-property "compiler.cpp.extra_flags=-fno-lto -fstack-usage" \
+        --build-property "compiler.c.elf.extra_flags=-fno-lto -Wl,-Map,$BUILD/tracker.map" \
+        "$SKETCH" > "$WORK/build.log" 2>&1; then
+    cat "$WORK/build.log" >&2
+    exit 2
+fi
+
+# avr-gcc's bin directory. Older arduino-cli releases print platform.txt
+# values unexpanded ("{runtime.tools.avr-gcc.path}/bin/"), so expand any
+# {key} from the other properties; failing that, use avr-objdump on the PATH.
+PROPS=$(arduino-cli compile --fqbn "$FQBN" --show-properties "$SKETCH" 2>/dev/null || true)
+TOOLS=$(printf '%s\n' "$PROPS" | awk '
+    { i = index($0, "="); if (i) prop[substr($0, 1, i - 1)] = substr($0, i + 1) }
+    END {
+        v = prop["compiler.path"]
+        for (n = 0; n < 10 && match(v, /[{][^}]+[}]/); n++) {
+            k = substr(v, RSTART + 1, RLENGTH - 2)
+            if (!(k in prop)) break
+            v = substr(v, 1, RSTART - 1) prop[k] substr(v, RSTART + RLENGTH)
+        }
+        print v
+    }')
+if [ ! -x "${TOOLS}avr-objdump" ] && command -v avr-objdump >/dev/null; then
+    TOOLS=$(dirname "$(command -v avr-objdump)")/
+fi
+if [ ! -x "${TOOLS}avr-objdump" ] || [ ! -x "${TOOLS}avr-nm" ]; then
+    echo "footprint: avr-objdump/avr-nm not found (compiler.path: ${TOOLS:-unset})" >&2
+    exit 2
+fi
+ELF=$BUILD/tracker.ino.elf
+
+# Module a source or object path belongs to
+MODULE_AWK='
+function module(path,    m) {
+    if (path ~ /lib(c|m|gcc)\.a|crt[^\/]*\.o/) return "avr-libc/libgcc"
+    if (match(path, /\/libraries\/[^\/]+/)) return substr(path, RSTART + 11, RLENGTH - 11)
+    if (path ~ /\/cores?\/|\/variants\//) return "core"
+    if (path ~ /\/sketch\/|main\.cpp/) return "main.cpp"
+    m = path; sub(/.*\//, "", m); return m
+}'
+
+# --- SIZES PER MODULE (linker map) ---
+awk "$MODULE_AWK"'
+function hex(s,    i, n, c) {
+    n = 0; s = tolower(s); sub(/^0x/, "", s)
+    for (i = 1; i <= length(s); i++) {
+        c = index("0123456789abcdef", substr(s, i, 1)) - 1
+        n = n * 16 + c
+    }
+    return n
+}
+function add(size, file,    m) {
+    if (out == "" || size == 0) return
+    m = module(file)
+    mods[m] = 1
+    bytes[m, out] += size
+}
+/^Linker script and memory map/ { inMap = 1; next }
+!inMap { next }
+/^[^ ]/ {
+    # Output section header
+    out = ""
+    if ($1 == ".text" || $1 == ".data" || $1 == ".bss") {
+        out = substr($1, 2)
+        if (NF >= 3) total[out] = hex($3)
+    }
+    pending = 0
+    next
+}
+/^ [^ *]/ && NF == 1 { pending = 1; next }                 # Long name, rest on next line
+pending && NF >= 3 && $1 ~ /^0x/ && $2 ~ /^0x/ { add(hex($2), $3); pending = 0; next }
+/^ [^ *]/ && NF >= 4 && $2 ~ /^0x/ && $3 ~ /^0x/ { add(hex($3), $4) }
+/^ COMMON/ && NF >= 4 { add(hex($3), $4) }
+{ pending = 0 }
+END {
+    printf "TOTAL %d %d %d\n", total["text"], total["data"], total["bss"]
+    for (m in mods) printf "MOD %s\t%d\t%d\t%d\n", m, bytes[m, "text"] + bytes[m, "data"], bytes[m, "data"], bytes[m, "bss"]
+}' "$BUILD/tracker.map" > "$WORK/sizes"
+
+# --- PEAK STACK (frame sizes + call graph) ---
+find "$BUILD" -name '*.su' -exec cat {} + > "$WORK/frames"
+if [ ! -s "$WORK/frames" ]; then
+    echo "footprint: no -fstack-usage output in $BUILD (extra_flags not applied?)" >&2
+    exit 2
+fi
+"${TOOLS}avr-objdump" -d -C "$ELF" > "$WORK/disasm"
+
+awk -F '\t' -v framesFile="$WORK/frames" "$MODULE_AWK"'
+# Qualified function name: "size_t Print::write(const uint8_t*, size_t)" -> Print::write
+function fname(decl) {
+    sub(/\(.*/, "", decl); sub(/.* /, "", decl); sub(/\+0x[0-9a-f]+$/, "", decl)
+    return decl
+}
+function fr(f) { return (f in frame) ? frame[f] : 0 }
+function depth(f,    d, best, c, n, i, list, v) {
+    if (f in memo) return memo[f]
+    if (f in visiting) { recursive[f] = 1; return fr(f) }
+    visiting[f] = 1
+    best = 0; next_[f] = ""
+    n = split(edges[f], list, SUBSEP)
+    for (i = 1; i <= n; i++) {
+        c = list[i]
+        if (c == "" || c == f) continue
+        d = 2 + depth(c)
+        if (d > best) { best = d; next_[f] = c }
+    }
+    if (f in indirect) {
+        for (v in virtuals) {
+            d = 2 + depth(v)
+            if (d > best) { best = d; next_[f] = v }
+        }
+    }
+    delete visiting[f]
+    memo[f] = fr(f) + best
+    return memo[f]
+}
+FILENAME == framesFile {
+    # path:line:col:declaration <TAB> bytes <TAB> static|dynamic|dynamic,bounded
+    decl = $1; sub(/^[^:]*:[0-9]+:[0-9]+:/, "", decl)
+    path = $1; sub(/:[0-9]+:[0-9]+:.*/, "", path)
+    f = fname(decl)
+    if (!(f in frame) || $2 + 0 > frame[f]) frame[f] = $2 + 0
+    if ($3 ~ /dynamic/ && $3 !~ /bounded/) dynamic[f] = 1
+    mod[f] = module(path)
+    next
+}
+/^[0-9a-f]+ <.*>:$/ {
+    cur = $0; sub(/^[0-9a-f]+ </, "", cur); sub(/>:$/, "", cur)
+    cur = fname(cur)
+    if (cur ~ /::(write|read|peek|available|flush)$/) virtuals[cur] = 1
+    if (cur ~ /^__vector_[0-9]+$/) vectors[cur] = 1
+    next
+}
+/\t(e)?icall/ { indirect[cur] = 1; next }
+/\t(r)?call\t/ || /\t(r)?jmp\t/ {
+    if (!match($0, /<.*>/)) next
+    t = fname(substr($0, RSTART + 1, RLENGTH - 2))
+    if (t != cur && t != "__bad_interrupt") edges[cur] = edges[cur] SUBSEP t
+}
+END {
+    mainDepth = depth("main")
+    for (f = "main"; f != ""; f = next_[f]) {
+        m = (f in mod) ? mod[f] : "avr-libc/libgcc"
+        note = (f in dynamic) ? " (alloca/VLA, unbounded)" : (f in frame) ? "" : " (no frame info, counted as 0)"
+        printf "CHAIN %d\t%d\t%s\t%s%s\n", fr(f), memo[f], m, f, note
+        share[m] += fr(f) + (next_[f] != "" ? 2 : 0)
+        if (f in recursive) break
+    }
+    isr = 0; isrName = "-"
+    for (v in vectors) if (depth(v) + 2 > isr) { isr = depth(v) + 2; isrName = v }
+    for (m in share) printf "STACKMOD %s\t%d\n", m, share[m]
+    printf "STACK %d %d %s\n", mainDepth, isr, isrName
+    for (f in recursive) printf "WARN Recursion through %s: the peak above covers one pass only\n", f
+}' "$WORK/frames" "$WORK/disasm" > "$WORK/stack"
+
+# --- REPORT ---
+read -r _ TEXT DATA BSS < <(grep '^TOTAL' "$WORK/sizes")
+read -r _ MAIN_STACK ISR_STACK ISR_NAME < <(grep '^STACK ' "$WORK/stack")
+PEAK_STACK=$((MAIN_STACK + ISR_STACK))
+FLASH=$((TEXT + DATA))
+HEAP=0
+if "${TOOLS}avr-nm" "$ELF" | awk '$NF == "malloc" { found = 1 } END { exit !found }'; then
+    HEAP=$HEAP_RESERVE
+fi
+RAM=$((DATA + BSS + HEAP + PEAK_STACK))
+
+echo "Footprint of main.cpp for $FQBN (LTO off)"
+echo
+printf "%-20s %8s %8s %8s %8s\n" "Module" "Flash" ".data" ".bss" "Stack"
+grep '^MOD ' "$WORK/sizes" | sed 's/^MOD //' | sort -t $'\t' -k2,2nr | while IFS=$'\t' read -r m flash data bss; do
+    stack=$(awk -F '\t' -v m="$m" '$1 == "STACKMOD " m { print $2 }' "$WORK/stack")
+    printf "%-20s %8d %8d %8d %8s\n" "$m" "$flash" "$data" "$bss" "${stack:--}"
+done
+printf "%-20s %8d %8d %8d %8d\n" "Total" "$FLASH" "$DATA" "$BSS" "$PEAK_STACK"
+echo "(Stack: bytes each module adds to the deepest call chain, plus $ISR_STACK for $ISR_NAME)"
+if [ "$HEAP" -gt 0 ]; then
+    echo "(Heap: malloc is linked in, $HEAP bytes of HEAP_RESERVE counted in RAM)"
+fi
+
+echo
+echo "Largest symbols:"
+"${TOOLS}avr-nm" -C -S --size-sort -t d "$ELF" | tail -n 15 | sort -k2,2nr |
+    awk '{ s = $4; for (i = 5; i <= NF; i++) s = s " " $i; printf "  %6d  %s  %s\n", $2, $3, s }'
+
+echo
+echo "Deepest call chain from main() ($MAIN_STACK bytes, 2 per return address):"
+printf "  %6s %6s  %-18s %s\n" "Frame" "Depth" "Module" "Function"
+grep '^CHAIN ' "$WORK/stack" | sed 's/^CHAIN //' | while IFS=$'\t' read -r frame depth m f; do
+    printf "  %6d %6d  %-18s %s\n" "$frame" "$depth" "$m" "$f"
+done
+
+grep '^WARN ' "$WORK/stack" | sed 's/^WARN /Warning: /' || true
+
+# --- BUDGETS ---
+echo
+status=0
+check() {
+    local name=$1 used=$2 budget=$3
+    if [ "$used" -gt "$budget" ]; then
+        printf "%-6s %6d / %6d bytes  OVER BUDGET\n" "$name" "$used" "$budget"
+        status=1
+    else
+        printf "%-6s %6d / %6d bytes  ok (%d free)\n" "$name" "$used" "$budget" $((budget - used))
+    fi
+}
+check FLASH "$FLASH" "$FLASH_BUDGET"
+check RAM "$RAM" "$RAM_BUDGET"
+check STACK "$PEAK_STACK" "$STACK_BUDGET"
+exit $status
@@ -0,0 +1,145 @@
+#ifndef ACTUATOR_H
+#define ACTUATOR_H
+
+#include <cmath>
+
+#include "Arduino.h"
+
+// Linear actuator + H-bridge plant for host tests and tools.
+//
+// Reads the H-bridge logic pins (IN1 = D9, IN2 = D8; PWM duty from
+// mock_analogWrite_vals) on every simulated millisecond, integrates a DC motor
+// model and writes the current-sense amplifier output (10 mA per count) to
+// mock_analogRead_vals[A2]. Position is in ms of travel at full speed, the
+// same unit main.cpp dead-reckons in. Attach with mock_actuator_attach().
+struct ActuatorModel {
+    // --- Parameters ---
+    bool dynamic = true;        // false: ideal kinematics, cheap enough for long sweeps
+    double supplyV = 12.0;
+    double resistance = 2.0;    // Ohm, stall current ~6 A
+    double inductance = 0.002;  // H
+    double backEmf = 10.0;      // V at full speed (~1 A running current)
+    double friction = 0.5;      // Coulomb load, amps of torque
+    double damping = 0.5;       // Viscous load, amps of torque at full speed
+    double inertia = 0.11;      // A*s per unit speed (~20 ms mechanical time constant)
+    double travel = 30000;      // Full stroke, ms at full speed
+    bool limitSwitches = false; // Internal switches open the motor circuit at either end
+    double jamAt = -1;          // Obstruction position (-1 = none)
+    int pinA = 9, pinB = 8, sensePin = A2;
+    double maPerCount = 10;
+
+    // --- State ---
+    double position = 0;
+    double speed = 0;           // 1.0 = full speed West (extending)
+    double current = 0;         // A, motor winding
+    double energyJ = 0;         // Drawn from the battery
+    double peakCurrent = 0;
+    unsigned long starts = 0;   // Moves begun (drive going from off to on)
+    long blockedSince = -1;     // mock millis when drive began pushing on an end/jam, -1 = not
+    bool driven = false;
+
+    double drive() const {
+        return (mock_analogWrite_vals[pinA] - mock_analogWrite_vals[pinB]) / 255.0;
+    }
+
+    bool blocked(double dir) const {
+        if (dir > 0 && position >= travel) return true;
+        if (dir < 0 && position <= 0) return true;
+        if (jamAt >= 0) {
+            if (dir > 0 && position >= jamAt && position - jamAt < 1.0) return true;
+            if (dir < 0 && position <= jamAt && jamAt - position < 1.0) return true;
+        }
+        return false;
+    }
+
+    void clampMotion(double before) {
+        if (position > travel) { position = travel; speed = 0; }
+        if (position < 0) { position = 0; speed = 0; }
+        if (jamAt >= 0 && (before - jamAt) * (position - jamAt) < 0) { position = jamAt; speed = 0; }
+    }
+
+    void step(double dtMs) {
+        double duty = drive();
+        double v = supplyV * duty;
+        double dir = (duty > 0) - (duty < 0);
+        bool push = dir != 0 && blocked(dir);
+        double before = position;
+        double dt = dtMs / 1000.0;
+
+        if (push && limitSwitches) {
+            current = 0;
+            speed = 0;
+        } else if (!dynamic) {
+            speed = push ? 0 : duty;
+            current = push ? v / resistance : duty * (supplyV - backEmf) / resistance;
+            position += speed * dtMs;
+        } else {
+            // Implicit Euler for the winding, explicit for the load
+            if (push) speed = 0;
+            current = (current + dt / inductance * (v - backEmf * speed)) / (1.0 + dt * resistance / inductance);
+            double force = current - damping * speed;
+            if (push || (speed == 0 && std::fabs(force) <= friction)) {
+                // Held by the obstruction, or by static friction
+            } else {
+                double sign = speed != 0 ? ((speed > 0) - (speed < 0)) : ((force > 0) - (force < 0));
+                double next = speed + (force - friction * sign) / inertia * dt;
+                speed = (speed != 0 && next * speed < 0) ? 0 : next;
+            }
+            position += speed * dtMs;
+        }
+        clampMotion(before);
+
+        double drawn = duty * current;
+        if (drawn > 0) energyJ += supplyV * drawn * dt;
+        if (std::fabs(current) > peakCurrent) peakCurrent = std::fabs(current);
+
+        int counts = (int)(std::fabs(current) * 1000.0 / maPerCount);
+        mock_analogRead_vals[sensePin] = counts > 1023 ? 1023 : counts;
+    }
+
+    void advance(unsigned long ms) {
+        double duty = drive();
+        bool on = duty != 0;
+        if (on && !driven) starts++;
+        driven = on;
+
+        // Nothing moving or flowing: skip ahead
+        if (!on && speed == 0 && std::fabs(current) < 1e-6) {
+            current = 0;
+            mock_analogRead_vals[sensePin] = 0;
+            mock_millis_val += ms;
+            return;
+        }
+        int substeps = dynamic ? 10 : 1;
+        for (unsigned long i = 0; i < ms; i++) {
+            for (int j = 0; j < substeps; j++) step(1.0 / substeps);
+            mock_millis_val++;
+            double dir = (duty > 0) - (duty < 0);
+            if (dir != 0 && blocked(dir)) {
+                if (blockedSince < 0) blockedSince = (long)mock_millis_val;
+            } else {
+                blockedSince = -1;
+            }
+        }
+    }
+};
+
+inline ActuatorModel& mock_actuator() {
+    static MOCK_TLS ActuatorModel model;
+    return model;
+}
+
+inline void mock_actuator_delay(unsigned long ms) { mock_actuator().advance(ms); }
+
+// Fresh model wired into delay()
+inline ActuatorModel& mock_actuator_attach() {
+    mock_actuator() = ActuatorModel();
+    mock_delay_hook = mock_actuator_delay;
+    return mock_actuator();
+}
+
+inline void mock_actuator_detach() {
+    mock_delay_hook = NULL;
+}
+
+#endif
@@ -1,13 +1,25 @@
 #include "Arduino.h"
 #include "RTClib.h"
+#include "EEPROM.h"
 
-volatile int mock_sink = 0;
-SerialClass Serial;
+MOCK_TLS volatile int mock_sink = 0;
+MOCK_TLS SerialClass Serial;
 
-unsigned long mock_millis_val = 0;
-int mock_digitalRead_vals[20] = {0};
-int mock_analogRead_vals[20] = {0};
-int mock_digitalWrite_vals[20] = {0};
-int mock_pinMode_vals[20] = {0};
+MOCK_TLS unsigned long mock_millis_val = 0;
+MOCK_TLS int mock_digitalRead_vals[20] = {0};
+MOCK_TLS int mock_analogRead_vals[20] = {0};
+MOCK_TLS int mock_digitalWrite_vals[20] = {0};
+MOCK_TLS int mock_pinMode_vals[20] = {0};
+MOCK_TLS int mock_analogWrite_vals[20] = {0};
+MOCK_TLS std::string mock_serial_input;
+MOCK_TLS void (*mock_delay_hook)(unsigned long ms) = NULL;
 
-DateTime mock_now_val = DateTime(2023, 6, 1, 12, 0, 0); // Default to Noon June 1st
+MOCK_TLS unsigned long mock_pinHighSince[20] = {0};
+MOCK_TLS unsigned long mock_pinHighMillis[20] = {0};
+MOCK_TLS unsigned long mock_pinRiseCount[20] = {0};
+
+MOCK_TLS uint8_t mock_eeprom_vals[MOCK_EEPROM_SIZE];
+MOCK_TLS unsigned long mock_eeprom_writes[MOCK_EEPROM_SIZE];
+MOCK_TLS EEPROMClass EEPROM;
+
+MOCK_TLS DateTime mock_now_val = DateTime(2023, 6, 1, 12, 0, 0); // Default to Noon June 1st
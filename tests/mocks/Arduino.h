@@ -3,17 +3,40 @@
 
 #include <cstring>
 #include <iostream>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
 
-extern volatile int mock_sink;
+// Built with -DMOCK_THREADS, all mock state is thread_local so host tools can
+// run several independent simulations of main.cpp side by side (see
+// tests/tuner.cpp). Otherwise it stays plain globals: TLS access roughly
+// halves loop() speed on the host, which the replay and benchmark feel.
+#ifdef MOCK_THREADS
+#define MOCK_TLS thread_local
+#else
+#define MOCK_TLS
+#endif
+
+extern MOCK_TLS volatile int mock_sink;
 
 // Mock control variables
-extern unsigned long mock_millis_val;
-extern int mock_digitalRead_vals[20];
-extern int mock_analogRead_vals[20];
-extern int mock_digitalWrite_vals[20];
-extern int mock_pinMode_vals[20];
+extern MOCK_TLS unsigned long mock_millis_val;
+extern MOCK_TLS int mock_digitalRead_vals[20];
+extern MOCK_TLS int mock_analogRead_vals[20];
+extern MOCK_TLS int mock_digitalWrite_vals[20];
+extern MOCK_TLS int mock_pinMode_vals[20];
+extern MOCK_TLS int mock_analogWrite_vals[20]; // Duty 0-255 (digitalWrite gives 0 or 255)
+extern MOCK_TLS std::string mock_serial_input;  // Bytes waiting to be read from Serial
+
+// Optional plant model hook: when set, delay() hands time to it instead of
+// just advancing mock_millis_val (see Actuator.h)
+extern MOCK_TLS void (*mock_delay_hook)(unsigned long ms);
+
+// Output pin bookkeeping (time spent HIGH and number of LOW->HIGH edges)
+extern MOCK_TLS unsigned long mock_pinHighSince[20];
+extern MOCK_TLS unsigned long mock_pinHighMillis[20];
+extern MOCK_TLS unsigned long mock_pinRiseCount[20];
 
 // Mock String class
 class String {
@@ -65,18 +88,45 @@ public:
     void print(int n, int f) { mock_sink += n; }
     void print(char c) { mock_sink += c; }
     void write(const uint8_t* buf, size_t size) { mock_sink += size; }
-    int available() { return 0; }
-    int read() { return -1; }
+    int available() { return (int)mock_serial_input.size(); }
+    int read() {
+        if (mock_serial_input.empty()) return -1;
+        char c = mock_serial_input[0];
+        mock_serial_input.erase(0, 1);
+        return c;
+    }
 };
-extern SerialClass Serial;
+extern MOCK_TLS SerialClass Serial;
 
 inline unsigned long millis() { return mock_millis_val; }
-inline void delay(unsigned long ms) { mock_millis_val += ms; }
+inline void delay(unsigned long ms) {
+    if (mock_delay_hook) mock_delay_hook(ms);
+    else mock_millis_val += ms;
+}
 inline void pinMode(int pin, int mode) { if(pin < 20) mock_pinMode_vals[pin] = mode; }
-inline void digitalWrite(int pin, int val) { if(pin < 20) mock_digitalWrite_vals[pin] = val; }
+inline void digitalWrite(int pin, int val) {
+    if(pin >= 20) return;
+    if(val != LOW && mock_digitalWrite_vals[pin] == LOW) {
+        mock_pinRiseCount[pin]++;
+        mock_pinHighSince[pin] = mock_millis_val;
+    } else if(val == LOW && mock_digitalWrite_vals[pin] != LOW) {
+        mock_pinHighMillis[pin] += mock_millis_val - mock_pinHighSince[pin];
+    }
+    mock_digitalWrite_vals[pin] = val;
+    mock_analogWrite_vals[pin] = (val != LOW) ? 255 : 0;
+}
+inline void analogWrite(int pin, int val) {
+    if(pin >= 20) return;
+    if(val < 0) val = 0;
+    if(val > 255) val = 255;
+    digitalWrite(pin, val ? HIGH : LOW);
+    mock_analogWrite_vals[pin] = val;
+}
 inline int digitalRead(int pin) { return (pin < 20) ? mock_digitalRead_vals[pin] : LOW; }
 inline int analogRead(int pin) { return (pin < 20) ? mock_analogRead_vals[pin] : 0; }
 inline int abs(int x) { return x > 0 ? x : -x; }
-inline const char* F(const char* s) { return s; }
+// No separate flash address space on the host: F() strings are plain strings
+typedef char __FlashStringHelper;
+inline const __FlashStringHelper* F(const char* s) { return s; }
 
 #endif
@@ -0,0 +1,44 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include "Arduino.h"
+
+#define MOCK_EEPROM_SIZE 1024 // ATmega328P
+
+extern MOCK_TLS uint8_t mock_eeprom_vals[MOCK_EEPROM_SIZE];
+extern MOCK_TLS unsigned long mock_eeprom_writes[MOCK_EEPROM_SIZE]; // Erase/write cycles per byte
+
+class EEPROMClass {
+public:
+    uint8_t read(int idx) { return (idx >= 0 && idx < MOCK_EEPROM_SIZE) ? mock_eeprom_vals[idx] : 0xFF; }
+    void write(int idx, uint8_t val) {
+        if (idx < 0 || idx >= MOCK_EEPROM_SIZE) return;
+        mock_eeprom_vals[idx] = val;
+        mock_eeprom_writes[idx]++;
+    }
+    void update(int idx, uint8_t val) { if (read(idx) != val) write(idx, val); }
+    uint16_t length() { return MOCK_EEPROM_SIZE; }
+
+    template <typename T> T& get(int idx, T& t) {
+        uint8_t* p = (uint8_t*)&t;
+        for (size_t i = 0; i < sizeof(T); i++) p[i] = read(idx + i);
+        return t;
+    }
+    template <typename T> const T& put(int idx, const T& t) {
+        const uint8_t* p = (const uint8_t*)&t;
+        for (size_t i = 0; i < sizeof(T); i++) update(idx + i, p[i]);
+        return t;
+    }
+};
+
+extern MOCK_TLS EEPROMClass EEPROM;
+
+// Blank chip, as shipped
+inline void mock_eeprom_erase() {
+    for (int i = 0; i < MOCK_EEPROM_SIZE; i++) {
+        mock_eeprom_vals[i] = 0xFF;
+        mock_eeprom_writes[i] = 0;
+    }
+}
+
+#endif
@@ -14,15 +14,42 @@ public:
     DateTime(const char* date, const char* time) : y(2023), m(1), d(1), hh(0), mm(0), ss(0) {}
     DateTime() : y(2023), m(1), d(1), hh(0), mm(0), ss(0) {}
 
+    // Seconds since 1970-01-01 00:00:00, as in the real RTClib
+    explicit DateTime(uint32_t t) {
+        ss = t % 60; t /= 60;
+        mm = t % 60; t /= 60;
+        hh = t % 24;
+        // Civil-from-days (proleptic Gregorian)
+        long z = (long)(t / 24) + 719468;
+        long era = z / 146097;
+        long doe = z - era * 146097;
+        long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        long mp = (5 * doy + 2) / 153;
+        d = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+        m = (uint8_t)(mp < 10 ? mp + 3 : mp - 9);
+        y = (uint16_t)(yoe + era * 400 + (m <= 2 ? 1 : 0));
+    }
+
     uint16_t year() const { return y; }
     uint8_t month() const { return m; }
     uint8_t day() const { return d; }
     uint8_t hour() const { return hh; }
     uint8_t minute() const { return mm; }
     uint8_t second() const { return ss; }
+
+    uint32_t unixtime() const {
+        long yy = y - (m <= 2 ? 1 : 0);
+        long era = yy / 400;
+        long yoe = yy - era * 400;
+        long doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        long days = era * 146097 + doe - 719468;
+        return (uint32_t)days * 86400UL + hh * 3600UL + mm * 60UL + ss;
+    }
 };
 
-extern DateTime mock_now_val;
+extern MOCK_TLS DateTime mock_now_val;
 
 class RTC_DS1307 {
 public:
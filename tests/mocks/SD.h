@@ -1,31 +1,411 @@
 #ifndef SD_H
 #define SD_H
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "Arduino.h"
 
+#define FILE_READ 0 // FILE_WRITE (read/write, create, append) is in Arduino.h
+
+// In-memory SD card, costed the way the Arduino SD library (SdFat) drives a
+// real one: a single 512-byte block cache with read-modify-write, FAT16 with a
+// mirrored second FAT, cluster chains walked on seek and the directory entry
+// rewritten on close/flush. File contents are really stored.
+//
+// Costs are CPU cycles at timing.cpuHz and accumulate in SD.stats; set
+// timing.advanceClock to also add the I/O time to millis().
+
+struct SdTiming {
+    unsigned long cpuHz = 16000000;
+    unsigned long spiCyclesPerByte = 40;    // SPI_HALF_SPEED (4 MHz) plus SPDR polling
+    unsigned long commandCycles = 640;      // CMD17/CMD24 frame and R1 response
+    unsigned long readAccessCycles = 1600;  // Card access time to the data token (~100 us)
+    unsigned long writeBusyCycles = 16000;  // Card busy programming the block (~1 ms)
+    unsigned long callCycles = 100;         // Library overhead per SD/File call
+    unsigned long cacheCycles = 30;         // Per block cache lookup
+    unsigned long byteCycles = 6;           // Copy to/from the cache, per byte
+    uint32_t blocksPerCluster = 64;         // 32 KB clusters (2 GB card)
+    uint32_t clusterCount = 65524;
+    bool advanceClock = false;
+};
+
+struct SdStats {
+    unsigned long sectorReads = 0;
+    unsigned long sectorWrites = 0;         // All blocks, including the two below
+    unsigned long dirUpdates = 0;           // Directory block writes
+    unsigned long fatUpdates = 0;           // FAT block writes (both copies)
+    unsigned long clustersAllocated = 0;
+    unsigned long cacheHits = 0;
+    unsigned long bytesWritten = 0;
+    unsigned long bytesRead = 0;
+    unsigned long long cycles = 0;
+};
+
+struct SdEntry {
+    std::string name;
+    std::string data;
+    std::vector<uint32_t> clusters;
+    uint32_t dirIndex;                      // 32-byte entry in the root directory
+};
+
+class SDClass;
+
 class File {
 public:
-    operator bool() const { return true; }
-    void close() {}
-    void println(const char* s) { mock_sink += s[0]; }
-    void println(const String& s) { mock_sink += s.c_str()[0]; }
-    void println(int n) { mock_sink += n; }
-    void print(const char* s) { mock_sink += s[0]; }
-    void print(const String& s) { mock_sink += s.c_str()[0]; }
-    void print(int n) { mock_sink += n; }
-    void print(int n, int f) { mock_sink += n; }
-    void print(char c) { mock_sink += c; }
-    int available() { return 0; }
-    int read(uint8_t* buf, size_t size) { return 0; }
+    File() : sd(NULL), entry(NULL), pos(0), writable(false), dirDirty(false) {}
+    File(SDClass* card, SdEntry* e, bool write) : sd(card), entry(e), pos(0), writable(write), dirDirty(false) {}
+
+    operator bool() const { return entry != NULL; }
+    const char* name() const { return entry ? entry->name.c_str() : ""; }
+    uint32_t size() const { return entry ? (uint32_t)entry->data.size() : 0; }
+    uint32_t position() const { return pos; }
+    int available() {
+        uint32_t left = size() - pos;
+        return left > 0x7FFF ? 0x7FFF : (int)left;
+    }
+
+    size_t write(const uint8_t* buf, size_t n);
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    int read(void* buf, size_t n);
+    int read() {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+    bool seek(uint32_t to);
+    void flush();
+    void close() {
+        flush();
+        entry = NULL;
+    }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC) {
+        if (n < 0 && base == DEC) return write((uint8_t)'-') + printNumber(-(unsigned long)n, base);
+        return printNumber((unsigned long)n, base);
+    }
+    size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+    template <typename T> size_t println(const T& v) { return print(v) + println(); }
+    template <typename T> size_t println(const T& v, int base) { return print(v, base) + println(); }
+    size_t println() { return write("\r\n"); }
+
+private:
+    size_t printNumber(unsigned long n, int base) {
+        char buf[33];
+        char* p = buf + sizeof(buf) - 1;
+        *p = '\0';
+        do {
+            int digit = n % base;
+            *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+            n /= base;
+        } while (n);
+        return write(p);
+    }
+    void nextCluster();
+
+    SDClass* sd;
+    SdEntry* entry;
+    uint32_t pos;
+    bool writable;
+    bool dirDirty;                          // Size or first cluster changed
 };
 
 class SDClass {
 public:
-    bool begin(int pin) { return true; }
-    bool exists(const char* filepath) { return true; }
-    File open(const char* filepath, int mode = 0) { return File(); }
+    SdTiming timing;
+    SdStats stats;
+
+    SDClass() : mounted(false), nextDirIndex(0), allocSearch(2), cacheBlock(NO_BLOCK), cacheDirty(false), clockResidue(0) {}
+
+    bool begin(int csPin) {
+        // MBR, then the volume boot block
+        readSector();
+        readSector();
+        cacheBlock = 0;
+        mounted = true;
+        return true;
+    }
+
+    bool exists(const char* path) {
+        spend(timing.callCycles);
+        return mounted && lookup(path) != NULL;
+    }
+
+    File open(const char* path, int mode = FILE_READ) {
+        spend(timing.callCycles);
+        if (!mounted) return File();
+        SdEntry* e = lookup(path);
+        if (!e && mode == FILE_WRITE) e = create(path);
+        if (!e) return File();
+        File f(this, e, mode == FILE_WRITE);
+        if (mode == FILE_WRITE) f.seek((uint32_t)e->data.size());
+        return f;
+    }
+
+    bool remove(const char* path) {
+        spend(timing.callCycles);
+        SdEntry* e = mounted ? lookup(path) : NULL;
+        if (!e) return false;
+        for (size_t i = 0; i < e->clusters.size(); i++) fatPut(e->clusters[i], 0);
+        if (!e->clusters.empty() && e->clusters[0] < allocSearch) allocSearch = e->clusters[0];
+        cacheRead(dirBlock(e->dirIndex), true);
+        cacheFlush();
+        files.erase(key(path));
+        return true;
+    }
+
+    // --- Mock only ---
+
+    // Blank card, counters cleared. Timing is kept.
+    void format() {
+        files.clear();
+        fat.clear();
+        mounted = false;
+        nextDirIndex = 0;
+        allocSearch = 2;
+        cacheBlock = NO_BLOCK;
+        cacheDirty = false;
+        clockResidue = 0;
+        stats = SdStats();
+    }
+
+    // File contents without touching the counters ("" if missing)
+    std::string contents(const char* path) {
+        std::map<std::string, SdEntry>::iterator it = files.find(key(path));
+        return it == files.end() ? std::string() : it->second.data;
+    }
+
+    double simulatedMs() const { return stats.cycles * 1000.0 / timing.cpuHz; }
+
+private:
+    friend class File;
+    static const uint32_t NO_BLOCK = 0xFFFFFFFF;
+    static const uint32_t FAT_START = 1;    // After the volume boot block
+    static const uint32_t ROOT_DIR_BLOCKS = 32; // 512 entries
+    static const uint32_t FAT_EOC = 0xFFFF;
+
+    uint32_t fatBlocks() const { return ((timing.clusterCount + 2) * 2 + 511) / 512; }
+    uint32_t rootDirStart() const { return FAT_START + 2 * fatBlocks(); }
+    uint32_t dataStart() const { return rootDirStart() + ROOT_DIR_BLOCKS; }
+    uint32_t clusterBytes() const { return timing.blocksPerCluster * 512; }
+    uint32_t fatBlock(uint32_t cluster) const { return FAT_START + cluster * 2 / 512; }
+    uint32_t dirBlock(uint32_t index) const { return rootDirStart() + index / 16; }
+    uint32_t dataBlock(uint32_t cluster, uint32_t offset) const {
+        return dataStart() + (cluster - 2) * timing.blocksPerCluster + offset / 512;
+    }
+
+    void spend(unsigned long long cycles) {
+        stats.cycles += cycles;
+        if (timing.advanceClock) {
+            unsigned long long perMs = timing.cpuHz / 1000;
+            clockResidue += cycles;
+            mock_millis_val += (unsigned long)(clockResidue / perMs);
+            clockResidue %= perMs;
+        }
+    }
+
+    // One block over SPI (512 bytes + CRC)
+    void readSector() {
+        stats.sectorReads++;
+        spend(timing.commandCycles + timing.readAccessCycles + 514UL * timing.spiCyclesPerByte);
+    }
+    void writeSector(uint32_t block) {
+        stats.sectorWrites++;
+        if (block >= FAT_START && block < rootDirStart()) stats.fatUpdates++;
+        else if (block >= rootDirStart() && block < dataStart()) stats.dirUpdates++;
+        spend(timing.commandCycles + 514UL * timing.spiCyclesPerByte + timing.writeBusyCycles);
+    }
+
+    // --- Block cache ---
+    void cacheFlush() {
+        if (!cacheDirty) return;
+        writeSector(cacheBlock);
+        if (cacheBlock >= FAT_START && cacheBlock < FAT_START + fatBlocks()) {
+            writeSector(cacheBlock + fatBlocks()); // Second FAT copy
+        }
+        cacheDirty = false;
+    }
+    void cacheRead(uint32_t block, bool forWrite) {
+        spend(timing.cacheCycles);
+        if (block == cacheBlock) {
+            stats.cacheHits++;
+        } else {
+            cacheFlush();
+            readSector();
+            cacheBlock = block;
+        }
+        if (forWrite) cacheDirty = true;
+    }
+    // Whole block about to be written from its start: no read needed
+    void cacheNew(uint32_t block) {
+        spend(timing.cacheCycles);
+        if (block != cacheBlock) {
+            cacheFlush();
+            cacheBlock = block;
+        }
+        cacheDirty = true;
+    }
+    void cacheInvalidate(uint32_t block) {
+        if (block == cacheBlock) {
+            cacheBlock = NO_BLOCK;
+            cacheDirty = false;
+        }
+    }
+
+    // --- FAT ---
+    uint32_t fatGet(uint32_t cluster) {
+        cacheRead(fatBlock(cluster), false);
+        return cluster < fat.size() ? fat[cluster] : 0;
+    }
+    void fatPut(uint32_t cluster, uint32_t next) {
+        cacheRead(fatBlock(cluster), true);
+        if (cluster >= fat.size()) fat.resize(cluster + 1, 0);
+        fat[cluster] = next;
+    }
+    // First free cluster from the search start, chained after prev (0 = none)
+    uint32_t allocCluster(uint32_t prev) {
+        for (uint32_t c = allocSearch; c < timing.clusterCount + 2; c++) {
+            if (fatGet(c) != 0) continue;
+            fatPut(c, FAT_EOC);
+            if (prev) fatPut(prev, c);
+            allocSearch = c + 1;
+            stats.clustersAllocated++;
+            return c;
+        }
+        return 0; // Card full
+    }
+
+    // --- Root directory ---
+    static std::string key(const char* path) {
+        std::string k;
+        for (const char* p = (*path == '/') ? path + 1 : path; *p; p++) k += (char)toupper(*p);
+        return k; // FAT names are case-insensitive
+    }
+    // Scans the directory blocks up to the entry (or the end if missing)
+    SdEntry* lookup(const char* path) {
+        std::map<std::string, SdEntry>::iterator it = files.find(key(path));
+        uint32_t last = (it != files.end()) ? it->second.dirIndex : nextDirIndex;
+        for (uint32_t b = 0; b <= last / 16; b++) cacheRead(rootDirStart() + b, false);
+        return it != files.end() ? &it->second : NULL;
+    }
+    SdEntry* create(const char* path) {
+        if (nextDirIndex >= ROOT_DIR_BLOCKS * 16) return NULL;
+        SdEntry& e = files[key(path)];
+        e.name = key(path);
+        e.dirIndex = nextDirIndex++;
+        cacheRead(dirBlock(e.dirIndex), true);
+        cacheFlush(); // SdFat writes a new entry straight away
+        return &e;
+    }
+
+    bool mounted;
+    std::map<std::string, SdEntry> files;
+    std::vector<uint32_t> fat;              // Next cluster, 0 = free (grows on demand)
+    uint32_t nextDirIndex;
+    uint32_t allocSearch;
+    uint32_t cacheBlock;
+    bool cacheDirty;
+    unsigned long long clockResidue;
 };
 
-extern SDClass SD;
+// Crossing into the cluster at pos: follow the chain, or grow it at the end
+inline void File::nextCluster() {
+    size_t index = pos / sd->clusterBytes();
+    if (index < entry->clusters.size()) {
+        if (index > 0) sd->fatGet(entry->clusters[index - 1]);
+        return;
+    }
+    uint32_t c = sd->allocCluster(entry->clusters.empty() ? 0 : entry->clusters.back());
+    if (!c) return;
+    entry->clusters.push_back(c);
+    dirDirty = true;
+}
+
+inline size_t File::write(const uint8_t* buf, size_t n) {
+    if (!entry || !writable) return 0;
+    sd->spend(sd->timing.callCycles);
+    size_t oldSize = entry->data.size();
+    size_t done = 0;
+    while (done < n) {
+        if (pos % sd->clusterBytes() == 0) {
+            nextCluster();
+            if (pos / sd->clusterBytes() >= entry->clusters.size()) break; // Card full
+        }
+        uint32_t block = sd->dataBlock(entry->clusters[pos / sd->clusterBytes()], pos % sd->clusterBytes());
+        uint32_t offset = pos % 512;
+        size_t chunk = 512 - offset;
+        if (chunk > n - done) chunk = n - done;
+
+        if (chunk == 512) {
+            sd->cacheInvalidate(block);
+            sd->writeSector(block);         // Full block goes straight to the card
+        } else if (offset == 0 && pos >= entry->data.size()) {
+            sd->cacheNew(block);
+        } else {
+            sd->cacheRead(block, true);     // Read-modify-write
+        }
+        entry->data.replace(pos, chunk, (const char*)buf + done, chunk);
+        sd->spend(sd->timing.byteCycles * chunk);
+        sd->stats.bytesWritten += chunk;
+        pos += chunk;
+        done += chunk;
+    }
+    if (pos > oldSize) dirDirty = true;   // Size changed: entry rewritten on flush
+    return done;
+}
+
+inline int File::read(void* buf, size_t n) {
+    if (!entry) return -1;
+    sd->spend(sd->timing.callCycles);
+    if (n > entry->data.size() - pos) n = entry->data.size() - pos;
+    size_t done = 0;
+    while (done < n) {
+        if (pos % sd->clusterBytes() == 0) nextCluster();
+        uint32_t block = sd->dataBlock(entry->clusters[pos / sd->clusterBytes()], pos % sd->clusterBytes());
+        uint32_t offset = pos % 512;
+        size_t chunk = 512 - offset;
+        if (chunk > n - done) chunk = n - done;
+
+        if (chunk == 512 && block != sd->cacheBlock) {
+            sd->readSector();               // Full block straight into buf
+        } else {
+            sd->cacheRead(block, false);
+        }
+        memcpy((uint8_t*)buf + done, entry->data.data() + pos, chunk);
+        sd->spend(sd->timing.byteCycles * chunk);
+        sd->stats.bytesRead += chunk;
+        pos += chunk;
+        done += chunk;
+    }
+    return (int)done;
+}
+
+// Walks the cluster chain from the start, as SdFat does
+inline bool File::seek(uint32_t to) {
+    if (!entry || to > entry->data.size()) return false;
+    sd->spend(sd->timing.callCycles);
+    uint32_t hops = to ? (to - 1) / sd->clusterBytes() : 0;
+    for (uint32_t i = 0; i < hops; i++) sd->fatGet(entry->clusters[i]);
+    pos = to;
+    return true;
+}
+
+inline void File::flush() {
+    if (!entry) return;
+    sd->spend(sd->timing.callCycles);
+    if (dirDirty) {
+        sd->cacheRead(sd->dirBlock(entry->dirIndex), true); // Flushes the data block first
+        dirDirty = false;
+    }
+    sd->cacheFlush();
+}
+
+extern MOCK_TLS SDClass SD;
 
 #endif
@@ -0,0 +1,424 @@
+// Field-log replay: drives the main.cpp state machine from a recorded
+// datalog.csv (as written by logData()) at full host speed and reports where
+// the current firmware's decisions differ from the logged events.
+//
+// Build: g++ -O2 -Itests/mocks tests/replay.cpp tests/mocks/Arduino.cpp -o replay
+// Usage: ./replay datalog.csv [--window S] [--show N] [--fail-on-divergence]
+//
+// LDR readings come from the TRACKING (East, West) and WAKE_UP (East) rows,
+// and NIGHT_RESET_INIT pins both to dark. They are linearly interpolated
+// between TRACKING rows and held across a night (dark from NIGHT_RESET_INIT
+// until WAKE_UP). Rows within the same minute are spread evenly across it.
+// loop() runs in step with the log clock (mock_now_val). While the firmware
+// waits (Idle before its next track, Night Mode, Dormancy) with the motor
+// off and nothing logged, the clock skips ahead to the next minute boundary,
+// so an hourly or 07:00 check is still hit. A NIGHT_RESET_INIT, WAKE_UP,
+// DORMANT or REDUNDANT_MOVE event matches when the firmware was in the logged
+// state (or, for WAKE_UP, left Night Mode) within +/- window seconds. The
+// default window is one TRACKING_INTERVAL. Extra = firmware entered that
+// state with no such event logged near it.
+//
+// Every TRACKING row is also a decision: the firmware's tracking pass is run
+// on the row's East/West readings and must settle, move East, move West or go
+// redundant as the logging tracker did. The logged decision is read from
+// what follows the row. Another TRACKING row (or a MOTOR_STALL or
+// END_OF_TRAVEL) within MOVE_GAP seconds means it moved. A REDUNDANT_MOVE
+// before the next TRACKING means it went redundant. Otherwise it settled.
+// The log has no direction, so a move is taken to follow the rig's
+// convention: West when A0 (East) is brighter.
+//
+// Logged readings are whatever readLDR() returned on the tracker. They are
+// fed back as raw analogRead() values, and the replay starts uncalibrated.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "RTClib.h"
+#include "SD.h"
+#include "SPI.h"
+#include "Wire.h"
+
+MOCK_TLS SDClass SD;
+
+#include "../main.cpp"
+
+enum LogEvent {
+    EV_TRACKING,
+    EV_NIGHT_RESET_INIT,
+    EV_WAKE_UP,
+    EV_DORMANT,
+    EV_REDUNDANT_MOVE,
+    EV_COUNT,
+    EV_OTHER = EV_COUNT
+};
+
+const char* const EVENT_NAMES[EV_COUNT] = {
+    "TRACKING", "NIGHT_RESET_INIT", "WAKE_UP", "DORMANT", "REDUNDANT_MOVE"
+};
+
+// State the firmware must be in for each event (WAKE_UP: leaving this state)
+const State EVENT_STATES[EV_COUNT] = {
+    STATE_TRACKING, STATE_NIGHT_RESET, STATE_NIGHT_RESET, STATE_STRATEGIC_DORMANCY, STATE_REDUNDANT
+};
+
+const char* const STATE_NAMES[] = {
+    "IDLE", "TRACKING", "NIGHT_RESET", "STRATEGIC_DORMANCY", "REDUNDANT", "ERROR"
+};
+
+// What a tracking pass did with its readings
+enum Decision { DEC_SETTLE, DEC_EAST, DEC_WEST, DEC_REDUNDANT };
+
+const char* const DECISION_NAMES[] = { "settle", "move East", "move West", "go redundant" };
+
+const uint32_t MOVE_GAP = 120; // s, a TRACKING row this soon after another continues its burst
+
+struct LogRow {
+    uint32_t time;   // RTC seconds
+    int event;       // LogEvent
+    int east, west;
+    bool sample;     // Carries LDR readings
+    bool step;       // Readings jump here instead of ramping in
+    bool moveFault;  // MOTOR_STALL / END_OF_TRAVEL: the drive was cut mid-move
+    int line;
+};
+
+// One stretch of firmware state during the replay
+struct Visit {
+    uint32_t enter, exit;
+    State state;
+};
+
+struct Divergence {
+    uint32_t time;
+    std::string text;
+};
+
+int eventFromName(const char* name) {
+    for (int i = 0; i < EV_COUNT; i++) {
+        if (strcmp(name, EVENT_NAMES[i]) == 0) return i;
+    }
+    return EV_OTHER;
+}
+
+bool loadLog(const char* path, std::vector<LogRow>& rows) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        int y, mo, d, h, mi, e, w, diff;
+        char name[64];
+        if (sscanf(line.c_str(), "%d/%d/%d,%d:%d,%63[^,],%d,%d,%d",
+                   &y, &mo, &d, &h, &mi, name, &e, &w, &diff) != 9) {
+            continue; // Header, blank or truncated (brownout mid-write)
+        }
+        LogRow row;
+        row.time = DateTime(y, mo, d, h, mi, 0).unixtime();
+        row.event = eventFromName(name);
+        row.east = e;
+        row.west = w;
+        row.sample = false;
+        row.step = false;
+        row.moveFault = strcmp(name, "MOTOR_STALL") == 0 || strcmp(name, "END_OF_TRAVEL") == 0;
+        row.line = lineNo;
+        if (row.event == EV_TRACKING) {
+            row.sample = true;
+        } else if (row.event == EV_WAKE_UP) {
+            row.west = e; // Only East is logged
+            row.sample = row.step = true;
+        } else if (row.event == EV_NIGHT_RESET_INIT) {
+            row.east = row.west = 0; // Only entered when both read dark
+            row.sample = row.step = true;
+        }
+        rows.push_back(row);
+    }
+    std::stable_sort(rows.begin(), rows.end(),
+                     [](const LogRow& a, const LogRow& b) { return a.time < b.time; });
+
+    // Spread rows sharing a minute across it, in log order
+    for (size_t i = 0; i < rows.size();) {
+        size_t j = i;
+        while (j < rows.size() && rows[j].time == rows[i].time) j++;
+        for (size_t k = i; k < j; k++) rows[k].time += (uint32_t)((k - i) * 60 / (j - i));
+        i = j;
+    }
+    return true;
+}
+
+std::string formatTime(uint32_t t) {
+    DateTime dt(t);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%d/%02d/%02d %02d:%02d:%02d",
+             dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second());
+    return buf;
+}
+
+// Any visit of `state` overlapping [from, to]? (visits are in time order)
+bool visited(const std::vector<Visit>& visits, State state, uint32_t from, uint32_t to) {
+    std::vector<Visit>::const_iterator it = std::lower_bound(
+        visits.begin(), visits.end(), from,
+        [](const Visit& v, uint32_t t) { return v.exit < t; });
+    for (; it != visits.end() && it->enter <= to; ++it) {
+        if (it->state == state) return true;
+    }
+    return false;
+}
+
+// Firmware left `state` somewhere in [from, to]?
+bool left(const std::vector<Visit>& visits, State state, uint32_t from, uint32_t to) {
+    std::vector<Visit>::const_iterator it = std::lower_bound(
+        visits.begin(), visits.end(), from,
+        [](const Visit& v, uint32_t t) { return v.exit < t; });
+    for (; it != visits.end() && it->enter <= to; ++it) {
+        if (it->state == state && it->exit >= from && it->exit <= to && it + 1 != visits.end()) return true;
+    }
+    return false;
+}
+
+State stateAt(const std::vector<Visit>& visits, uint32_t t) {
+    std::vector<Visit>::const_iterator it = std::lower_bound(
+        visits.begin(), visits.end(), t,
+        [](const Visit& v, uint32_t x) { return v.exit < x; });
+    return it != visits.end() ? it->state : visits.back().state;
+}
+
+// What the logging tracker did after TRACKING row i (see the header)
+Decision loggedDecision(const std::vector<LogRow>& rows, size_t i) {
+    const LogRow& row = rows[i];
+    for (size_t j = i + 1; j < rows.size(); j++) {
+        const LogRow& r = rows[j];
+        if (r.event == EV_REDUNDANT_MOVE) return DEC_REDUNDANT;
+        if (r.time - row.time <= MOVE_GAP && (r.event == EV_TRACKING || r.moveFault)) {
+            return row.east > row.west ? DEC_WEST : DEC_EAST;
+        }
+        if (r.event != EV_OTHER) break;
+    }
+    return DEC_SETTLE;
+}
+
+// One tracking pass of the current firmware on a row's readings, from
+// mid-stroke so no end stop gets in the way
+Decision firmwareDecision(const LogRow& row) {
+    stopMotor();
+    currentState = STATE_TRACKING;
+    actuatorPosition = ACTUATOR_TRAVEL_TIME / 2;
+    mock_analogRead_vals[LDR_EAST] = row.east;
+    mock_analogRead_vals[LDR_WEST] = row.west;
+    mock_now_val = DateTime(row.time);
+    runTrackingState();
+    if (currentState == STATE_REDUNDANT) return DEC_REDUNDANT;
+    if (actuatorPosition > ACTUATOR_TRAVEL_TIME / 2) return DEC_WEST;
+    if (actuatorPosition < ACTUATOR_TRAVEL_TIME / 2) return DEC_EAST;
+    return DEC_SETTLE;
+}
+
+// Logged event of this type within [from, to]?
+bool logged(const std::vector<uint32_t>& times, uint32_t from, uint32_t to) {
+    std::vector<uint32_t>::const_iterator it = std::lower_bound(times.begin(), times.end(), from);
+    return it != times.end() && *it <= to;
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    uint32_t window = TRACKING_INTERVAL / 1000;
+    size_t show = 20;
+    bool failOnDivergence = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--window" && hasValue) window = strtoul(argv[++i], NULL, 10);
+        else if (arg == "--show" && hasValue) show = strtoul(argv[++i], NULL, 10);
+        else if (arg == "--fail-on-divergence") failOnDivergence = true;
+        else if (arg[0] != '-' && !path) path = argv[i];
+        else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        std::cerr << "Usage: " << argv[0] << " datalog.csv [--window S] [--show N] [--fail-on-divergence]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::vector<LogRow> rows;
+    if (!loadLog(path, rows)) {
+        std::cerr << "Cannot read " << path << std::endl;
+        return 1;
+    }
+    if (rows.empty()) {
+        std::cerr << "No log rows in " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<const LogRow*> samples;
+    std::vector<uint32_t> eventTimes[EV_COUNT];
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (rows[i].sample) samples.push_back(&rows[i]);
+        if (rows[i].event < EV_COUNT) eventTimes[rows[i].event].push_back(rows[i].time);
+    }
+
+    const uint32_t start = rows.front().time;
+    const uint32_t end = rows.back().time + window;
+
+    // --- REPLAY ---
+    auto wallStart = std::chrono::steady_clock::now();
+
+    mock_eeprom_erase();
+    SD.format();
+    mock_now_val = DateTime(start);
+    mock_analogRead_vals[LDR_EAST] = samples.empty() ? 500 : samples.front()->east;
+    mock_analogRead_vals[LDR_WEST] = samples.empty() ? 500 : samples.front()->west;
+    setup();
+    if (rows.front().event == EV_WAKE_UP) {
+        // Log opens at night: carry on as the logging tracker was
+        currentState = STATE_NIGHT_RESET;
+        nightModeInitialized = true;
+    }
+
+    std::vector<Visit> visits;
+    Visit current = { start, start, currentState };
+    std::vector<Divergence> divergences;
+    unsigned long extra[EV_COUNT] = { 0 };
+    unsigned long loops = 0;
+    size_t next = 0; // First sample after the current time
+    size_t nextRow = 0; // First log row after the current time
+
+    for (uint32_t now = start; now <= end; now = start + (uint32_t)(mock_millis_val / 1000)) {
+        // Interpolate the LDRs at the log clock
+        while (next < samples.size() && samples[next]->time <= now) next++;
+        int east, west;
+        if (samples.empty()) {
+            east = west = 500;
+        } else if (next == 0 || next == samples.size() || samples[next]->step ||
+                   samples[next - 1]->event != EV_TRACKING) {
+            const LogRow* s = samples[next == 0 ? 0 : next - 1];
+            east = s->east;
+            west = s->west;
+        } else {
+            const LogRow* a = samples[next - 1];
+            const LogRow* b = samples[next];
+            long span = (long)(b->time - a->time);
+            long into = (long)(now - a->time);
+            east = a->east + (int)((long)(b->east - a->east) * into / span);
+            west = a->west + (int)((long)(b->west - a->west) * into / span);
+        }
+        mock_analogRead_vals[LDR_EAST] = east;
+        mock_analogRead_vals[LDR_WEST] = west;
+        mock_now_val = DateTime(now);
+
+        State before = currentState;
+        loop();
+        loops++;
+
+        // Nothing to do until the next minute: skip to it
+        uint32_t after = start + (uint32_t)(mock_millis_val / 1000);
+        uint32_t boundary = after - after % 60 + 60;
+        while (nextRow < rows.size() && rows[nextRow].time <= after) nextRow++;
+        bool waiting = currentState == STATE_NIGHT_RESET || currentState == STATE_STRATEGIC_DORMANCY ||
+                       (currentState == STATE_IDLE &&
+                        mock_millis_val + (boundary - after) * 1000UL - lastTrackTime <= TRACKING_INTERVAL);
+        if (waiting && currentState == before && motorDirection == 0 && calibrationSamples < 0 &&
+            (nextRow == rows.size() || rows[nextRow].time >= boundary)) {
+            mock_millis_val += (boundary - after) * 1000UL;
+        }
+
+        if (currentState != before) {
+            current.exit = now;
+            visits.push_back(current);
+            current.enter = now;
+            current.state = currentState;
+
+            // Firmware decision with no matching logged event nearby
+            uint32_t from = now > window ? now - window : 0;
+            for (int e = 0; e < EV_COUNT; e++) {
+                bool entered = e != EV_WAKE_UP && currentState == EVENT_STATES[e];
+                bool exited = e == EV_WAKE_UP && before == EVENT_STATES[e];
+                if ((entered || exited) && !logged(eventTimes[e], from, now + window)) {
+                    extra[e]++;
+                    divergences.push_back({ now, std::string("firmware ") +
+                        (exited ? "left " : "entered ") + STATE_NAMES[e == EV_WAKE_UP ? before : currentState] +
+                        ", no " + EVENT_NAMES[e] + " logged" });
+                }
+            }
+        }
+    }
+    current.exit = end;
+    visits.push_back(current);
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // --- LOGGED EVENTS vs FIRMWARE ---
+    unsigned long matched[EV_COUNT] = { 0 };
+    unsigned long missed[EV_COUNT] = { 0 };
+    for (size_t i = 0; i < rows.size(); i++) {
+        const LogRow& row = rows[i];
+        if (row.event >= EV_COUNT) continue;
+        if (row.event == EV_TRACKING) {
+            Decision want = loggedDecision(rows, i);
+            Decision got = firmwareDecision(row);
+            if (got == want) {
+                matched[row.event]++;
+            } else {
+                missed[row.event]++;
+                char text[160];
+                snprintf(text, sizeof(text), "TRACKING logged (line %d, E %d W %d): logged %s, firmware would %s",
+                         row.line, row.east, row.west, DECISION_NAMES[want], DECISION_NAMES[got]);
+                divergences.push_back({ row.time, text });
+            }
+            continue;
+        }
+        uint32_t from = row.time > window ? row.time - window : 0;
+        State s = EVENT_STATES[row.event];
+        bool ok = (row.event == EV_WAKE_UP) ? left(visits, s, from, row.time + window)
+                                            : visited(visits, s, from, row.time + window);
+        if (ok) {
+            matched[row.event]++;
+        } else {
+            missed[row.event]++;
+            char text[160];
+            snprintf(text, sizeof(text), "%s logged (line %d), firmware was %s",
+                     EVENT_NAMES[row.event], row.line, STATE_NAMES[stateAt(visits, row.time)]);
+            divergences.push_back({ row.time, text });
+        }
+    }
+    std::stable_sort(divergences.begin(), divergences.end(),
+                     [](const Divergence& a, const Divergence& b) { return a.time < b.time; });
+
+    // --- REPORT ---
+    double days = (end - start) / 86400.0;
+    printf("Replayed %zu rows, %s .. %s (%.1f days)\n", rows.size(),
+           formatTime(start).c_str(), formatTime(rows.back().time).c_str(), days);
+    printf("%lu loop() calls in %.3f s (%.0f days/s), match window +/-%us\n\n",
+           loops, wallSeconds, wallSeconds > 0 ? days / wallSeconds : 0.0, window);
+
+    printf("%-18s %8s %8s %8s %8s\n", "Event", "Logged", "Matched", "Missed", "Extra");
+    unsigned long total = 0;
+    for (int e = 0; e < EV_COUNT; e++) {
+        printf("%-18s %8zu %8lu %8lu %8lu\n", EVENT_NAMES[e], eventTimes[e].size(),
+               matched[e], missed[e], extra[e]);
+        total += missed[e] + extra[e];
+    }
+
+    if (total == 0) {
+        printf("\nNo divergences.\n");
+        return 0;
+    }
+    printf("\n%lu divergence(s)%s:\n", total, divergences.size() > show ? ", first shown" : "");
+    for (size_t i = 0; i < divergences.size() && i < show; i++) {
+        printf("  %s  %s\n", formatTime(divergences[i].time).c_str(), divergences[i].text.c_str());
+    }
+    return failOnDivergence ? 2 : 0;
+}
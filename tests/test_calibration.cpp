@@ -0,0 +1,220 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "RTClib.h"
+#include "SD.h"
+#include "SPI.h"
+#include "Wire.h"
+
+// Define global mock objects required by main.cpp
+MOCK_TLS SDClass SD;
+
+// Include application code
+#include "../main.cpp"
+
+const LdrCalibration IDENTITY = { CAL_MAGIC, { CAL_ONE, CAL_ONE }, { 0, 0 }, 0 };
+
+// West divider reads low and offset: what a mismatched LDR pair looks like
+int mismatchedWest(int light) {
+    int v = (int)(light * 0.8 + 30);
+    return v > 1023 ? 1023 : v;
+}
+
+// Helper to reset state
+void reset_test_env() {
+    mock_eeprom_erase();
+    ldrCal = IDENTITY;
+    calibrationSamples = -1;
+    currentState = STATE_IDLE;
+    lastTrackTime = 0;
+    mock_millis_val = 0;
+    mock_serial_input.clear();
+    for(int i=0; i<20; i++) {
+        mock_digitalRead_vals[i] = LOW;
+        mock_digitalWrite_vals[i] = LOW;
+        mock_analogRead_vals[i] = 0;
+    }
+    mock_analogRead_vals[LDR_EAST] = 500;
+    mock_analogRead_vals[LDR_WEST] = 500;
+    mock_now_val = DateTime(2023, 6, 1, 12, 0, 0);
+}
+
+// Feed a calibration run through the serial command, light sweeping lo..hi
+void run_calibration(int lo, int hi) {
+    mock_serial_input = "c";
+    for (int i = 0; i <= CAL_SAMPLES; i++) {
+        int light = lo + (hi - lo) * i / CAL_SAMPLES;
+        mock_analogRead_vals[LDR_EAST] = light;
+        mock_analogRead_vals[LDR_WEST] = mismatchedWest(light);
+        loop();
+    }
+}
+
+void test_identity_by_default() {
+    std::cout << "Test: Uncalibrated Readings Pass Through..." << std::endl;
+    reset_test_env();
+
+    mock_analogRead_vals[LDR_EAST] = 321;
+    mock_analogRead_vals[LDR_WEST] = 654;
+    if (readLDR(LDR_EAST) != 321 || readLDR(LDR_WEST) != 654) {
+        std::cout << "FAIL: Identity calibration changed the readings" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_gain_and_offset_learned() {
+    std::cout << "Test: Gain & Offset Learned Under Uniform Light..." << std::endl;
+    reset_test_env();
+
+    run_calibration(200, 800);
+
+    if (calibrationSamples != -1) {
+        std::cout << "FAIL: Calibration should have finished" << std::endl;
+        exit(1);
+    }
+    for (int light = 150; light <= 900; light += 50) {
+        mock_analogRead_vals[LDR_EAST] = light;
+        mock_analogRead_vals[LDR_WEST] = mismatchedWest(light);
+        int diff = readLDR(LDR_EAST) - readLDR(LDR_WEST);
+        if (abs(diff) > 3) {
+            std::cout << "FAIL: Calibrated diff " << diff << " at light " << light << std::endl;
+            exit(1);
+        }
+    }
+
+    // Coefficients survive a reset
+    LdrCalibration learned = ldrCal;
+    ldrCal = IDENTITY;
+    loadCalibration();
+    if (ldrCal.gain[1] != learned.gain[1] || ldrCal.offset[1] != learned.offset[1]) {
+        std::cout << "FAIL: Calibration not restored from EEPROM" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_gain_only_at_steady_light() {
+    std::cout << "Test: Steady Light Fits Gain Only..." << std::endl;
+    reset_test_env();
+
+    run_calibration(600, 610);
+
+    if (ldrCal.offset[0] != 0 || ldrCal.offset[1] != 0) {
+        std::cout << "FAIL: Offset should stay 0 without a light range" << std::endl;
+        exit(1);
+    }
+    mock_analogRead_vals[LDR_EAST] = 605;
+    mock_analogRead_vals[LDR_WEST] = mismatchedWest(605);
+    int diff = readLDR(LDR_EAST) - readLDR(LDR_WEST);
+    if (abs(diff) > 3) {
+        std::cout << "FAIL: Calibrated diff " << diff << " at the calibration light level" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_health_check_after_calibration() {
+    std::cout << "Test: Sensor Health Uses Calibrated Values..." << std::endl;
+    reset_test_env();
+    run_calibration(200, 800);
+
+    // Shorted West sensor still reads as a fault
+    mock_analogRead_vals[LDR_EAST] = 500;
+    mock_analogRead_vals[LDR_WEST] = 1023;
+    if (isSensorOperational()) {
+        std::cout << "FAIL: Shorted sensor (1023) should fail the health check" << std::endl;
+        exit(1);
+    }
+    // Broken East wire
+    mock_analogRead_vals[LDR_EAST] = 0;
+    mock_analogRead_vals[LDR_WEST] = 500;
+    if (isSensorOperational()) {
+        std::cout << "FAIL: Open sensor (0) should fail the health check" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_dusk_after_calibration() {
+    std::cout << "Test: Dusk Still Reads Dark After Calibration..." << std::endl;
+    reset_test_env();
+    run_calibration(200, 800);
+    if (ldrCal.offset[0] <= 0 || ldrCal.offset[1] >= 0) {
+        std::cout << "SETUP FAIL: Expected +East/-West offsets, got " << ldrCal.offset[0] << " / "
+                  << ldrCal.offset[1] << std::endl;
+        exit(1);
+    }
+
+    const int darkRaw[] = { 2, 4, 6 };
+    for (int raw : darkRaw) {
+        currentState = STATE_IDLE;
+        nightModeInitialized = false;
+        mock_digitalWrite_vals[LED_PIN] = LOW;
+        mock_now_val = DateTime(2023, 6, 1, 21, 0, 0);
+        mock_analogRead_vals[LDR_EAST] = raw;
+        mock_analogRead_vals[LDR_WEST] = raw;
+        if (readLDR(LDR_EAST) >= LDR_DARK_THRESHOLD || readLDR(LDR_WEST) >= LDR_DARK_THRESHOLD) {
+            std::cout << "FAIL: Raw " << raw << " reads " << readLDR(LDR_EAST) << " / " << readLDR(LDR_WEST)
+                      << ", not dark" << std::endl;
+            exit(1);
+        }
+        loop(); // To Night Reset
+        loop(); // LEDs on, retract
+        if (currentState != STATE_NIGHT_RESET || mock_digitalWrite_vals[LED_PIN] != HIGH) {
+            std::cout << "FAIL: Raw " << raw << " at 21:00 should start Night Mode, got state "
+                      << currentState << std::endl;
+            exit(1);
+        }
+    }
+
+    // Dim but lit: the offset only fades, it does not vanish at once
+    mock_analogRead_vals[LDR_EAST] = 60;
+    mock_analogRead_vals[LDR_WEST] = mismatchedWest(60);
+    if (abs(readLDR(LDR_EAST) - readLDR(LDR_WEST)) >= LDR_THRESHOLD) {
+        std::cout << "FAIL: Dim calibrated diff " << readLDR(LDR_EAST) - readLDR(LDR_WEST) << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_rejects_bad_calibration() {
+    std::cout << "Test: Bad Calibration Rejected..." << std::endl;
+    reset_test_env();
+
+    // Too dark to learn anything
+    run_calibration(20, 40);
+    if (ldrCal.gain[1] != CAL_ONE || ldrCal.offset[1] != 0) {
+        std::cout << "FAIL: Dark calibration should be rejected" << std::endl;
+        exit(1);
+    }
+
+    // Sensor fault mid-run aborts, tracking resumes
+    mock_serial_input = "c";
+    loop();
+    mock_analogRead_vals[LDR_WEST] = 0;
+    loop();
+    if (calibrationSamples != -1 || ldrCal.gain[1] != CAL_ONE) {
+        std::cout << "FAIL: Sensor fault should abort calibration" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "Running LDR Calibration Tests..." << std::endl;
+    setup();
+
+    test_identity_by_default();
+    test_gain_and_offset_learned();
+    test_gain_only_at_steady_light();
+    test_health_check_after_calibration();
+    test_dusk_after_calibration();
+    test_rejects_bad_calibration();
+
+    std::cout << "All Tests Passed!" << std::endl;
+    return 0;
+}
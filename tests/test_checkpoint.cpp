@@ -0,0 +1,358 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "RTClib.h"
+#include "SD.h"
+#include "SPI.h"
+#include "Wire.h"
+
+// Define global mock objects required by main.cpp
+MOCK_TLS SDClass SD;
+
+// Include application code
+#include "../main.cpp"
+
+// Helper to simulate a reset: RAM back to power-on values, EEPROM untouched
+void power_cycle() {
+    currentState = STATE_IDLE;
+    nightModeInitialized = false;
+    nightEntryTime = 0;
+    ledStartTime = 0;
+    ledOn = false;
+    lastTrackTime = 0;
+    lastTrackRtc = 0;
+    actuatorPosition = 0;
+    positionResidue = 0;
+    motorDirection = 0;
+    motorStartTime = 0;
+    motorDuty = 0;
+    checkpointSlot = -1;
+    checkpointMillis = 0;
+    retractPending = false;
+    mock_millis_val = 0;
+    for(int i=0; i<20; i++) {
+        mock_digitalWrite_vals[i] = LOW;
+    }
+}
+
+// Helper to reset state
+void reset_test_env() {
+    mock_eeprom_erase();
+    power_cycle();
+    for(int i=0; i<20; i++) {
+        mock_digitalRead_vals[i] = LOW;
+        mock_analogRead_vals[i] = 0;
+    }
+    // Set default safe sensor values
+    mock_analogRead_vals[LDR_EAST] = 500;
+    mock_analogRead_vals[LDR_WEST] = 500;
+
+    // Set default time to Noon
+    mock_now_val = DateTime(2023, 6, 1, 12, 0, 0);
+    setup();
+}
+
+void advance(unsigned long seconds) {
+    mock_millis_val += seconds * 1000UL;
+    mock_now_val = DateTime(mock_now_val.unixtime() + seconds);
+}
+
+void test_brownout_in_night_mode() {
+    std::cout << "Test: Brownout During Night Mode..." << std::endl;
+    reset_test_env();
+
+    // Enter Night Mode at 19:00 and let the retraction finish
+    mock_now_val = DateTime(2023, 6, 1, 19, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 4;
+    mock_analogRead_vals[LDR_WEST] = 4;
+    loop(); // To Night Reset
+    loop(); // LED ON, retracting
+    advance(60);
+    loop(); // Retraction done
+
+    if (mock_digitalWrite_vals[LED_PIN] != HIGH || mock_digitalWrite_vals[ACT_RETRACT] != LOW) {
+        std::cout << "SETUP FAIL: Night Mode not running" << std::endl;
+        exit(1);
+    }
+
+    // Brownout for 10 minutes, then boot
+    power_cycle();
+    advance(600);
+    mock_millis_val = 0;
+    unsigned long retractsBefore = mock_pinRiseCount[ACT_RETRACT];
+    setup();
+
+    if (currentState != STATE_NIGHT_RESET || !nightModeInitialized) {
+        std::cout << "FAIL: State should resume as STATE_NIGHT_RESET, got " << currentState << std::endl;
+        exit(1);
+    }
+    if (mock_digitalWrite_vals[LED_PIN] != HIGH) {
+        std::cout << "FAIL: LED Pin 7 should be restored HIGH" << std::endl;
+        exit(1);
+    }
+    loop();
+    if (mock_pinRiseCount[ACT_RETRACT] != retractsBefore) {
+        std::cout << "FAIL: Panel was already home, it should not re-home" << std::endl;
+        exit(1);
+    }
+
+    // LED budget continues: ~4h minus the 11 minutes already used (LED on at 19:00)
+    advance(3 * 3600 + 40 * 60);
+    loop();
+    if (mock_digitalWrite_vals[LED_PIN] != HIGH) {
+        std::cout << "FAIL: LED turned off before the remaining budget" << std::endl;
+        exit(1);
+    }
+    advance(10 * 60);
+    loop();
+    if (mock_digitalWrite_vals[LED_PIN] != LOW) {
+        std::cout << "FAIL: LED should be off once the 4 hour budget is spent" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_resume_mid_retraction() {
+    std::cout << "Test: Brownout Mid-Retraction Resumes In loop()..." << std::endl;
+    reset_test_env();
+    actuatorPosition = 20000;
+
+    mock_now_val = DateTime(2023, 6, 1, 19, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 4;
+    mock_analogRead_vals[LDR_WEST] = 4;
+    loop(); // To Night Reset
+    loop(); // LED ON, retracting
+    loop(); // Still retracting, progress saved
+    long saved = actuatorPosition;
+    if (motorDirection != -1 || saved >= 20000) {
+        std::cout << "SETUP FAIL: Expected a retraction under way" << std::endl;
+        exit(1);
+    }
+
+    power_cycle();
+    advance(30);
+    mock_millis_val = 0;
+    setup();
+    if (motorDirection != 0 || mock_digitalWrite_vals[ACT_RETRACT] != LOW) {
+        std::cout << "FAIL: setup() must not drive the actuator (current unwatched)" << std::endl;
+        exit(1);
+    }
+    loop();
+    if (motorDirection != -1 || actuatorPosition >= saved) {
+        std::cout << "FAIL: First loop() pass should resume the retraction" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < 30; i++) {
+        advance(1);
+        loop();
+    }
+    if (motorDirection != 0 || actuatorPosition != 0) {
+        std::cout << "FAIL: Retraction should finish at home, position " << actuatorPosition << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_position_and_track_time() {
+    std::cout << "Test: Position & Last Track Time Restore..." << std::endl;
+    reset_test_env();
+
+    // Sun to the West: track until balanced
+    currentState = STATE_TRACKING;
+    mock_analogRead_vals[LDR_EAST] = 400;
+    mock_analogRead_vals[LDR_WEST] = 600;
+    loop(); // Moves East, but home already -> position stays 0
+    mock_analogRead_vals[LDR_EAST] = 600;
+    mock_analogRead_vals[LDR_WEST] = 400;
+    loop(); // West 500ms (+ soft start/stop ramps)
+    loop(); // West 500ms (+ soft start/stop ramps)
+    mock_analogRead_vals[LDR_WEST] = 600;
+    loop(); // Balanced -> Idle, lastTrackRtc set
+
+    long position = actuatorPosition;
+    if (position < 1000 || position > 1300 || currentState != STATE_IDLE) {
+        std::cout << "SETUP FAIL: expected position ~1150 in Idle, got " << position << std::endl;
+        exit(1);
+    }
+
+    // Reset 2 minutes later: next track is due 8 minutes after boot, not 10
+    power_cycle();
+    advance(120);
+    mock_millis_val = 0;
+    setup();
+
+    if (actuatorPosition != position) {
+        std::cout << "FAIL: Position should be " << position << ", got " << actuatorPosition << std::endl;
+        exit(1);
+    }
+    advance(7 * 60);
+    loop();
+    if (currentState != STATE_IDLE) {
+        std::cout << "FAIL: Tracked too early after resume" << std::endl;
+        exit(1);
+    }
+    advance(2 * 60);
+    loop();
+    if (currentState != STATE_TRACKING) {
+        std::cout << "FAIL: Should track 10 minutes after the last track" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_corrupt_slot_falls_back() {
+    std::cout << "Test: Corrupt Checkpoint Falls Back..." << std::endl;
+    reset_test_env();
+
+    currentState = STATE_STRATEGIC_DORMANCY;
+    mock_analogRead_vals[LDR_EAST] = 100;
+    loop(); // Saved: Dormancy
+    int goodSlot = checkpointSlot;
+
+    currentState = STATE_REDUNDANT;
+    mock_now_val = DateTime(2023, 6, 1, 12, 0, 1); // Avoid the hourly DORMANT log path
+    saveCheckpoint(); // Saved: Redundant, newer slot
+
+    // Flip a bit in the newest slot (torn write during brownout)
+    int addr = CHECKPOINT_ADDR + checkpointSlot * (int)sizeof(Checkpoint) + offsetof(Checkpoint, state);
+    mock_eeprom_vals[addr] ^= 0x01;
+
+    power_cycle();
+    setup();
+
+    if (checkpointSlot != goodSlot || currentState != STATE_STRATEGIC_DORMANCY) {
+        std::cout << "FAIL: Should restore previous good slot (Dormancy), got " << currentState << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_stale_checkpoint() {
+    std::cout << "Test: Stale Checkpoint Re-evaluates..." << std::endl;
+    reset_test_env();
+
+    currentState = STATE_REDUNDANT;
+    actuatorPosition = 12000;
+    saveCheckpoint();
+
+    // Off for a day
+    power_cycle();
+    advance(24 * 3600);
+    mock_millis_val = 0;
+    setup();
+
+    if (currentState != STATE_IDLE || actuatorPosition != 12000) {
+        std::cout << "FAIL: Expected Idle with position kept, got state " << currentState
+                  << " position " << actuatorPosition << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_brownout_late_in_night() {
+    std::cout << "Test: Brownout Hours Into Night Mode..." << std::endl;
+    reset_test_env();
+
+    // Night from 19:00; LEDs off at 23:00, nothing changes after that
+    mock_now_val = DateTime(2023, 6, 1, 19, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 4;
+    mock_analogRead_vals[LDR_WEST] = 4;
+    loop(); // To Night Reset
+    while (mock_now_val.hour() != 1 || mock_now_val.minute() != 30) {
+        advance(60);
+        loop();
+    }
+    if (currentState != STATE_NIGHT_RESET || mock_digitalWrite_vals[LED_PIN] != LOW) {
+        std::cout << "SETUP FAIL: Expected Night Mode with LEDs off at 01:30" << std::endl;
+        exit(1);
+    }
+
+    // The heartbeat kept the checkpoint fresh: resume the night, not Idle
+    power_cycle();
+    advance(60);
+    mock_millis_val = 0;
+    setup();
+    if (currentState != STATE_NIGHT_RESET || !nightModeInitialized || mock_digitalWrite_vals[LED_PIN] != LOW) {
+        std::cout << "FAIL: Should resume Night Mode with LEDs off, got state " << currentState << std::endl;
+        exit(1);
+    }
+    loop();
+    if (currentState != STATE_NIGHT_RESET) {
+        std::cout << "FAIL: Left Night Mode before morning, state " << currentState << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_clock_behind_checkpoint() {
+    std::cout << "Test: RTC Behind Checkpoint Is Stale..." << std::endl;
+    reset_test_env();
+
+    mock_now_val = DateTime(2023, 6, 1, 21, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 4;
+    mock_analogRead_vals[LDR_WEST] = 4;
+    loop(); // To Night Reset
+    loop(); // LED ON, saved
+    if (mock_digitalWrite_vals[LED_PIN] != HIGH) {
+        std::cout << "SETUP FAIL: LED not on" << std::endl;
+        exit(1);
+    }
+
+    // RTC lost power and was set back to an earlier (compile) time
+    power_cycle();
+    mock_now_val = DateTime(2023, 5, 20, 10, 0, 0);
+    setup();
+    if (currentState != STATE_IDLE || mock_digitalWrite_vals[LED_PIN] != LOW) {
+        std::cout << "FAIL: Checkpoint from the clock's future restored, state " << currentState << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_wear_levelling() {
+    std::cout << "Test: Wear Levelling..." << std::endl;
+    reset_test_env();
+
+    const int SAVES = 256 + CHECKPOINT_SLOTS / 2; // Newest slots straddle the seq wrap
+    for (int i = 0; i < SAVES; i++) {
+        currentState = (i % 2) ? STATE_TRACKING : STATE_IDLE;
+        saveCheckpoint();
+    }
+
+    unsigned long worst = 0;
+    for (int i = 0; i < CHECKPOINT_SLOTS * (int)sizeof(Checkpoint); i++) {
+        if (mock_eeprom_writes[i] > worst) worst = mock_eeprom_writes[i];
+    }
+    if (worst > (unsigned long)(SAVES / CHECKPOINT_SLOTS) + 2) {
+        std::cout << "FAIL: A byte was written " << worst << " times for " << SAVES << " saves" << std::endl;
+        exit(1);
+    }
+
+    // seq wraps past 255 and the newest slot must still win
+    power_cycle();
+    setup();
+    if (currentState != STATE_TRACKING) {
+        std::cout << "FAIL: Newest checkpoint not restored after seq wrap" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Checkpoint Tests..." << std::endl;
+
+    test_brownout_in_night_mode();
+    test_resume_mid_retraction();
+    test_position_and_track_time();
+    test_corrupt_slot_falls_back();
+    test_stale_checkpoint();
+    test_brownout_late_in_night();
+    test_clock_behind_checkpoint();
+    test_wear_levelling();
+
+    std::cout << "All Tests Passed!" << std::endl;
+    return 0;
+}
@@ -9,12 +9,12 @@
 #include "Wire.h"
 
 // Define global mock objects required by main.cpp
-SDClass SD;
+MOCK_TLS SDClass SD;
 
 // Forward declarations for functions in main.cpp
 void checkSerialCommand();
 void dumpDataLog();
-void logData(const char* mode, int e, int w, int d);
+void logData(const __FlashStringHelper* mode, int e, int w, int d);
 void runIdleState();
 void runTrackingState();
 void runNightResetState();
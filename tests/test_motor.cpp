@@ -0,0 +1,186 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+#include "Arduino.h"
+#include "Actuator.h"
+#include "EEPROM.h"
+#include "RTClib.h"
+#include "SD.h"
+#include "SPI.h"
+#include "Wire.h"
+
+// Define global mock objects required by main.cpp
+MOCK_TLS SDClass SD;
+
+// Include application code
+#include "../main.cpp"
+
+// Helper to reset state, with the actuator model wired to the H-bridge pins
+ActuatorModel& reset_test_env(double position) {
+    mock_eeprom_erase();
+    currentState = STATE_IDLE;
+    nightModeInitialized = false;
+    lastTrackTime = 0;
+    mock_millis_val = 0;
+    for(int i=0; i<20; i++) {
+        mock_digitalRead_vals[i] = LOW;
+        mock_digitalWrite_vals[i] = LOW;
+        mock_analogWrite_vals[i] = 0;
+        mock_analogRead_vals[i] = 0;
+        mock_pinHighMillis[i] = 0;
+    }
+    mock_analogRead_vals[LDR_EAST] = 500;
+    mock_analogRead_vals[LDR_WEST] = 500;
+    mock_now_val = DateTime(2023, 6, 1, 12, 0, 0);
+
+    ActuatorModel& act = mock_actuator_attach();
+    act.position = position;
+    actuatorPosition = (long)position;
+    positionResidue = 0;
+    motorDirection = 0;
+    motorDuty = 0;
+    motorStartTime = 0;
+    return act;
+}
+
+void test_soft_start() {
+    std::cout << "Test: Soft Start Limits Inrush..." << std::endl;
+    ActuatorModel& act = reset_test_env(10000);
+
+    bool ok = driveActuator(1, 500);
+
+    if (!ok || mock_analogWrite_vals[ACT_EXTEND] != 0 || mock_digitalWrite_vals[ACT_RETRACT] != LOW) {
+        std::cout << "FAIL: Normal move should complete and leave the drive off" << std::endl;
+        exit(1);
+    }
+    // Full-voltage start would peak near 12V / 2R = 6A
+    if (act.peakCurrent > 2.5) {
+        std::cout << "FAIL: Peak current " << act.peakCurrent << "A, soft start should keep it under 2.5A" << std::endl;
+        exit(1);
+    }
+    // Duty-weighted dead reckoning should track the real travel
+    long moved = actuatorPosition - 10000;
+    double real = act.position - 10000;
+    if (moved < real * 0.8 || moved > real * 1.25) {
+        std::cout << "FAIL: Estimated travel " << moved << "ms vs real " << real << "ms" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_stall_cutoff() {
+    std::cout << "Test: Stall Cut-Off..." << std::endl;
+    ActuatorModel& act = reset_test_env(10000);
+    act.jamAt = 10200; // Obstruction ~0.2s into the move
+
+    bool ok = driveActuator(1, 2000);
+
+    if (ok) {
+        std::cout << "FAIL: Move into a jam should report failure" << std::endl;
+        exit(1);
+    }
+    if (mock_analogWrite_vals[ACT_EXTEND] != 0 || mock_digitalWrite_vals[ACT_RETRACT] != LOW) {
+        std::cout << "FAIL: Drive should be cut after a stall" << std::endl;
+        exit(1);
+    }
+    long cutAfter = (long)mock_millis_val - act.blockedSince;
+    if (act.blockedSince < 0 || cutAfter > (long)CURRENT_TRIP_TIME + 20) {
+        std::cout << "FAIL: Drive cut " << cutAfter << "ms after the stall" << std::endl;
+        exit(1);
+    }
+    if (actuatorPosition == ACTUATOR_TRAVEL_TIME) {
+        std::cout << "FAIL: A mid-stroke stall must not be taken as end of travel" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_end_of_travel_switch() {
+    std::cout << "Test: Night Retract Stops At End-Of-Travel Switch..." << std::endl;
+    ActuatorModel& act = reset_test_env(1000);
+    act.limitSwitches = true;
+    actuatorPosition = 5000; // Estimate has drifted
+
+    mock_now_val = DateTime(2023, 6, 1, 18, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 4;
+    mock_analogRead_vals[LDR_WEST] = 4;
+    loop(); // To Night Reset
+    loop(); // Start retracting
+    loop(); // Reaches home during this pass
+
+    if (mock_digitalWrite_vals[ACT_RETRACT] != LOW || mock_analogWrite_vals[ACT_EXTEND] != 0) {
+        std::cout << "FAIL: Drive should be cut once the end-of-travel switch opens" << std::endl;
+        exit(1);
+    }
+    // Old drive held pin 8 for the full 30 s
+    if (mock_pinHighMillis[ACT_RETRACT] > 1000 + SOFT_START_TIME + 100) {
+        std::cout << "FAIL: Retract drive stayed on for " << mock_pinHighMillis[ACT_RETRACT] << "ms" << std::endl;
+        exit(1);
+    }
+    if (actuatorPosition != 0 || act.position != 0) {
+        std::cout << "FAIL: Estimate should re-home to 0, got " << actuatorPosition << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_end_stop_stall() {
+    std::cout << "Test: Retract Into End Stop (No Switch)..." << std::endl;
+    ActuatorModel& act = reset_test_env(300);
+
+    bool ok = driveActuator(-1, 2000);
+
+    long cutAfter = (long)mock_millis_val - act.blockedSince;
+    if (ok || act.blockedSince < 0 || cutAfter > (long)CURRENT_TRIP_TIME + 20) {
+        std::cout << "FAIL: Stall on the end stop should cut within ms, took " << cutAfter << "ms" << std::endl;
+        exit(1);
+    }
+    if (actuatorPosition != 0) {
+        std::cout << "FAIL: Stall near home should re-home the estimate, got " << actuatorPosition << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_night_retract_stall() {
+    std::cout << "Test: Night Retract Into A Jam Is Cut..." << std::endl;
+    ActuatorModel& act = reset_test_env(8000);
+    act.jamAt = 7000; // Obstruction ~1s into the retraction
+
+    mock_now_val = DateTime(2023, 6, 1, 18, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 4;
+    mock_analogRead_vals[LDR_WEST] = 4;
+    loop(); // To Night Reset
+    loop(); // Start retracting
+    loop(); // Hits the jam while the loop waits
+
+    long cutAfter = (long)mock_millis_val - act.blockedSince;
+    if (act.blockedSince < 0 || mock_digitalWrite_vals[ACT_RETRACT] != LOW || mock_analogWrite_vals[ACT_EXTEND] != 0) {
+        std::cout << "FAIL: Retract drive should be cut at the jam" << std::endl;
+        exit(1);
+    }
+    if (mock_pinHighMillis[ACT_RETRACT] > (unsigned long)(1000 + SOFT_START_TIME + CURRENT_TRIP_TIME + 20)) {
+        std::cout << "FAIL: Retract drive pushed on the jam for " << cutAfter << "ms" << std::endl;
+        exit(1);
+    }
+    if (currentState != STATE_NIGHT_RESET || mock_digitalWrite_vals[LED_PIN] != HIGH) {
+        std::cout << "FAIL: Night Mode should carry on after the cut" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Motor Drive Tests..." << std::endl;
+    setup();
+
+    test_soft_start();
+    test_stall_cutoff();
+    test_end_of_travel_switch();
+    test_end_stop_stall();
+    test_night_retract_stall();
+
+    std::cout << "All Tests Passed!" << std::endl;
+    return 0;
+}
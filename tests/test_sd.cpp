@@ -0,0 +1,166 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "RTClib.h"
+#include "SD.h"
+#include "SPI.h"
+#include "Wire.h"
+
+// Define global mock objects required by main.cpp
+MOCK_TLS SDClass SD;
+
+// Include application code
+#include "../main.cpp"
+
+// Helper to reset state: blank card, default geometry and timing, booted
+void reset_test_env() {
+    mock_eeprom_erase();
+    SD.timing = SdTiming();
+    SD.format();
+    currentState = STATE_IDLE;
+    mock_millis_val = 0;
+    mock_serial_input.clear();
+    mock_analogRead_vals[LDR_EAST] = 500;
+    mock_analogRead_vals[LDR_WEST] = 500;
+    mock_now_val = DateTime(2023, 6, 1, 12, 0, 0);
+    setup();
+}
+
+void test_rows_stored() {
+    std::cout << "Test: Log Rows Stored On The Card..." << std::endl;
+    reset_test_env();
+
+    logData(F("TRACKING"), 500, 400, 100);
+    mock_now_val = DateTime(2023, 6, 1, 12, 5, 0);
+    logData(F("WAKE_UP"), 160, 0, -3);
+
+    std::string expected =
+        "Date,Time,Event,East,West,Diff\r\n"
+        "2023/6/1,12:0,System Start,0,0,0\r\n"
+        "2023/6/1,12:0,TRACKING,500,400,100\r\n"
+        "2023/6/1,12:5,WAKE_UP,160,0,-3\r\n";
+    if (SD.contents("datalog.csv") != expected) {
+        std::cout << "FAIL: datalog.csv holds:\n" << SD.contents("datalog.csv") << std::endl;
+        exit(1);
+    }
+
+    // A reboot must not write a second header
+    setup();
+    if (SD.contents("datalog.csv").find("Date,", 1) != std::string::npos) {
+        std::cout << "FAIL: Header written again after a reboot" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_append_cost() {
+    std::cout << "Test: Append Costs Data + Directory Block..." << std::endl;
+    reset_test_env();
+
+    logData(F("TRACKING"), 500, 400, 100); // Settle the cache
+    SdStats before = SD.stats;
+    logData(F("TRACKING"), 500, 400, 100);
+    SdStats after = SD.stats;
+
+    // Data block read-modify-write, then the directory entry for the new size
+    if (after.sectorWrites - before.sectorWrites != 2 || after.dirUpdates - before.dirUpdates != 1 ||
+        after.fatUpdates != before.fatUpdates) {
+        std::cout << "FAIL: Expected 2 writes (1 directory, 0 FAT), got " << after.sectorWrites - before.sectorWrites
+                  << " (" << after.dirUpdates - before.dirUpdates << " directory, "
+                  << after.fatUpdates - before.fatUpdates << " FAT)" << std::endl;
+        exit(1);
+    }
+    if (after.sectorReads - before.sectorReads != 2) {
+        std::cout << "FAIL: Expected 2 block reads (data, directory), got "
+                  << after.sectorReads - before.sectorReads << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_cluster_allocation() {
+    std::cout << "Test: New Clusters Update Both FATs..." << std::endl;
+    reset_test_env();
+    SD.timing.blocksPerCluster = 1; // 512 byte clusters: a new one every ~14 rows
+    SD.format();
+    setup();
+
+    for (int i = 0; i < 100; i++) logData(F("TRACKING"), 500, 400, 100);
+
+    size_t size = SD.contents("datalog.csv").size();
+    unsigned long clusters = (size + 511) / 512;
+    if (SD.stats.clustersAllocated != clusters) {
+        std::cout << "FAIL: " << SD.stats.clustersAllocated << " clusters allocated for " << size << " bytes" << std::endl;
+        exit(1);
+    }
+    // Each allocation is flushed as one FAT block, written to both copies
+    if (SD.stats.fatUpdates != 2 * clusters) {
+        std::cout << "FAIL: " << SD.stats.fatUpdates << " FAT writes for " << clusters << " clusters" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_dump_reads_log() {
+    std::cout << "Test: Data Dump Reads The Whole Log..." << std::endl;
+    reset_test_env();
+    for (int i = 0; i < 200; i++) logData(F("TRACKING"), 500, 400, 100);
+
+    size_t size = SD.contents("datalog.csv").size();
+    SdStats before = SD.stats;
+    mock_serial_input = "d";
+    checkSerialCommand();
+
+    unsigned long blocks = (size + 511) / 512;
+    unsigned long reads = SD.stats.sectorReads - before.sectorReads;
+    if (SD.stats.bytesRead - before.bytesRead != size) {
+        std::cout << "FAIL: Dump read " << SD.stats.bytesRead - before.bytesRead << " of " << size << " bytes" << std::endl;
+        exit(1);
+    }
+    // 64 byte reads go through the cache: each data block is read once
+    if (reads < blocks || reads > blocks + 2 || SD.stats.sectorWrites != before.sectorWrites) {
+        std::cout << "FAIL: " << reads << " block reads (and " << SD.stats.sectorWrites - before.sectorWrites
+                  << " writes) to dump " << blocks << " blocks" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+void test_clock_advance() {
+    std::cout << "Test: I/O Time Advances millis() When Enabled..." << std::endl;
+    reset_test_env();
+
+    unsigned long t0 = mock_millis_val;
+    logData(F("TRACKING"), 500, 400, 100);
+    if (mock_millis_val != t0) {
+        std::cout << "FAIL: Clock moved with advanceClock off" << std::endl;
+        exit(1);
+    }
+
+    SD.timing.advanceClock = true;
+    double ms0 = SD.simulatedMs();
+    logData(F("TRACKING"), 500, 400, 100);
+    double cost = SD.simulatedMs() - ms0;
+    long moved = (long)(mock_millis_val - t0);
+    if (cost < 1.0 || moved < (long)cost - 1 || moved > (long)cost + 1) {
+        std::cout << "FAIL: millis() moved " << moved << "ms for " << cost << "ms of I/O" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "Running SD Card Model Tests..." << std::endl;
+
+    test_rows_stored();
+    test_append_cost();
+    test_cluster_allocation();
+    test_dump_reads_log();
+    test_clock_advance();
+
+    std::cout << "All Tests Passed!" << std::endl;
+    return 0;
+}
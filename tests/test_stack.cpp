@@ -0,0 +1,149 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include <ucontext.h>
+
+#include "Arduino.h"
+#include "Actuator.h"
+#include "EEPROM.h"
+#include "RTClib.h"
+#include "SD.h"
+#include "SPI.h"
+#include "Wire.h"
+
+// Define global mock objects required by main.cpp
+MOCK_TLS SDClass SD;
+
+// Include application code
+#include "../main.cpp"
+
+// The firmware runs on its own painted stack so the watermark is exact.
+// Host frames are 64-bit and unoptimised, several times the AVR ones: this
+// budget only catches regressions (a big local buffer, runaway call depth).
+// tests/footprint.sh gives the real AVR figure.
+const size_t HOST_STACK_SIZE = 64 * 1024;
+const size_t HOST_STACK_BUDGET = 1536;
+
+uint8_t firmwareStack[HOST_STACK_SIZE];
+ucontext_t harnessContext, firmwareContext;
+void (*scenario)();
+
+void runScenario() {
+    scenario();
+}
+
+// Bytes of firmwareStack the scenario used at its deepest
+size_t stack_used_by(void (*fn)()) {
+    memset(firmwareStack, STACK_PAINT, sizeof(firmwareStack));
+    scenario = fn;
+    getcontext(&firmwareContext);
+    firmwareContext.uc_stack.ss_sp = firmwareStack;
+    firmwareContext.uc_stack.ss_size = sizeof(firmwareStack);
+    firmwareContext.uc_link = &harnessContext;
+    makecontext(&firmwareContext, runScenario, 0);
+    swapcontext(&harnessContext, &firmwareContext);
+    return HOST_STACK_SIZE - unusedStack(firmwareStack, firmwareStack + HOST_STACK_SIZE);
+}
+
+// Helper to reset state
+void reset_test_env() {
+    mock_eeprom_erase();
+    currentState = STATE_IDLE;
+    nightModeInitialized = false;
+    lastTrackTime = 0;
+    calibrationSamples = -1;
+    mock_millis_val = 0;
+    mock_serial_input.clear();
+    for(int i=0; i<20; i++) {
+        mock_digitalRead_vals[i] = LOW;
+        mock_digitalWrite_vals[i] = LOW;
+        mock_analogRead_vals[i] = 0;
+    }
+    mock_analogRead_vals[LDR_EAST] = 500;
+    mock_analogRead_vals[LDR_WEST] = 500;
+    mock_now_val = DateTime(2023, 6, 1, 12, 0, 0);
+}
+
+void boot_and_serial_commands() {
+    setup();
+    mock_serial_input = "dwes";
+    for (int i = 0; i < 4; i++) loop();
+}
+
+void calibration_run() {
+    mock_serial_input = "c";
+    for (int i = 0; i <= CAL_SAMPLES; i++) {
+        mock_analogRead_vals[LDR_EAST] = 200 + 10 * i;
+        mock_analogRead_vals[LDR_WEST] = 230 + 8 * i;
+        loop();
+    }
+}
+
+void tracking_into_a_jam() {
+    ActuatorModel& act = mock_actuator_attach();
+    act.position = 10000;
+    act.jamAt = 10300;
+    actuatorPosition = 10000;
+    currentState = STATE_TRACKING;
+    mock_analogRead_vals[LDR_EAST] = 700;
+    mock_analogRead_vals[LDR_WEST] = 400;
+    for (int i = 0; i < 3; i++) loop(); // Moves, then MOTOR_STALL is logged mid-ramp
+    mock_actuator_detach();
+}
+
+void night_dormancy_redundant() {
+    mock_now_val = DateTime(2023, 6, 1, 21, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 4;
+    mock_analogRead_vals[LDR_WEST] = 4;
+    for (int i = 0; i < 3; i++) loop(); // Night Reset
+    mock_now_val = DateTime(2023, 6, 2, 6, 0, 0);
+    mock_analogRead_vals[LDR_EAST] = 300;
+    loop(); // Wake up
+    mock_analogRead_vals[LDR_EAST] = 4;
+    for (int i = 0; i < 2; i++) loop(); // Dark by day: Dormancy
+    currentState = STATE_REDUNDANT;
+    lastTrackTime = 0;
+    mock_millis_val = TRACKING_INTERVAL + 1;
+    loop(); // Dead-reckoning move
+}
+
+void test_stack_watermark() {
+    std::cout << "Test: Stack Watermark Within Host Budget..." << std::endl;
+
+    struct { const char* name; void (*fn)(); } scenarios[] = {
+        { "boot + serial d/w/e/s", boot_and_serial_commands },
+        { "LDR calibration", calibration_run },
+        { "tracking into a jam", tracking_into_a_jam },
+        { "night/dormancy/redundant", night_dormancy_redundant },
+    };
+    size_t worst = 0;
+    for (auto& s : scenarios) {
+        // Warm-up on the normal stack: the dynamic linker resolving libc calls
+        // on first use takes kilobytes of stack the firmware never would
+        reset_test_env();
+        s.fn();
+        reset_test_env();
+        size_t used = stack_used_by(s.fn);
+        std::cout << "  " << s.name << ": " << used << " bytes" << std::endl;
+        if (used > worst) worst = used;
+    }
+
+    if (worst == 0 || worst == HOST_STACK_SIZE) {
+        std::cout << "FAIL: Watermark not measured (" << worst << " bytes)" << std::endl;
+        exit(1);
+    }
+    if (worst > HOST_STACK_BUDGET) {
+        std::cout << "FAIL: Peak stack " << worst << " bytes, budget " << HOST_STACK_BUDGET << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Stack Tests..." << std::endl;
+
+    test_stack_watermark();
+
+    std::cout << "All Tests Passed!" << std::endl;
+    return 0;
+}
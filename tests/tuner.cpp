@@ -0,0 +1,491 @@
+// Host-side parameter sweep for the tracker thresholds.
+//
+// Runs the main.cpp state machine against synthetic or recorded light traces
+// for a grid (default) or random sample of parameter sets, one simulation per
+// thread-pool job, and ranks the sets by energy captured, actuator cycles and
+// time spent in the wrong state.
+//
+// Build: g++ -O2 -pthread -DMOCK_THREADS -Itests/mocks tests/tuner.cpp tests/mocks/Arduino.cpp -o tuner
+// Usage: ./tuner [--random N] [--seed S] [--threads T] [--top K]
+//                [--stroke MS] [--cycle-cost WH] [--wrong-cost WH]
+//                [--mismatch GAIN,OFFSET] [--calibrate] [--trace FILE]... [--fault HH:MM]...
+//
+// Score = energy (Wh per m2 of panel) - cycle-cost * actuator pulses
+//         - wrong-cost * hours in the wrong state.
+//
+// A trace file holds one day of sky transmittance (0.0 = black cloud,
+// 1.0 = clear sky), one "HH:MM,transmittance" line per minute. Missing
+// minutes repeat the previous value. Give --trace once per day to simulate.
+// --fault HH:MM adds a clear day on which the West LDR goes open circuit at
+// that time, so redundant mode (and REDUNDANT_MOVE_TIME) is exercised; the
+// synthetic days include one at 09:00. Without a fault day REDUNDANT_MOVE_TIME
+// cannot change the result and is not swept.
+//
+// Sensor mounting follows the firmware: it moves West when A0 (LDR_EAST)
+// reads brighter, so the A0 LDR looks West of the panel normal and A1 East.
+// Before sweeping, a clear day with the firmware values must keep the panel
+// within MAX_TRACK_ERROR_DEG of the sun, or the plant model is wrong.
+//
+// --mismatch makes the West LDR read GAIN * true + OFFSET counts (unequal
+// LDRs/dividers). --calibrate runs the firmware's 'c' calibration under
+// uniform, varying light before each simulation. With --mismatch the firmware
+// defaults are also shown with the other calibration setting for comparison.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+#include "Actuator.h"
+#include "EEPROM.h"
+#include "RTClib.h"
+#include "SD.h"
+#include "SPI.h"
+#include "Wire.h"
+
+// Give every worker thread its own copy of the firmware globals
+#ifndef MOCK_THREADS
+#error "Build the tuner with -DMOCK_THREADS (per-thread mock state)"
+#endif
+#define TRACKER_STATE thread_local
+#define TRACKER_PARAM thread_local
+
+MOCK_TLS SDClass SD;
+
+#include "../main.cpp"
+
+// --- SIMULATED SITE (Irish June) ---
+const double SUNRISE_S = 5.0 * 3600;   // 05:00
+const double SUNSET_S = 22.0 * 3600;   // 22:00
+const double TWILIGHT_S = 45.0 * 60;   // Civil twilight either side
+const double PEAK_IRRADIANCE = 1000.0; // W/m2, clear sky at solar noon
+const double PANEL_RANGE_DEG = 50.0;   // Panel swings +/- this from flat
+const double LDR_TILT_DEG = 30.0;      // Each LDR faces this far off the panel normal (A0 West, A1 East)
+const double LDR_KNEE = 300.0;         // W/m2 at which the divider reads half scale
+const double DAYLIGHT_MIN = 30.0;      // W/m2, below this any daytime state is acceptable
+const double MAX_TRACK_ERROR_DEG = 20.0; // Plant check: worst |sun - panel| on a clear day
+const double PI_D = 3.14159265358979323846;
+
+struct Params {
+    unsigned long trackingInterval;
+    int ldrThreshold;
+    unsigned long redundantMoveTime;
+    int darkThreshold;
+    int wakeThreshold;
+};
+
+struct Result {
+    Params params;
+    double energyWh;
+    unsigned long cycles;
+    double pulsesPerDay;
+    double wrongHours;
+    double maxTrackErrorDeg; // Worst |sun - panel| in direct sun within the panel's range
+    double score;
+};
+
+struct Sky {
+    double direct;  // W/m2 normal to the sun
+    double diffuse; // W/m2 from the whole sky
+    double angle;   // Sun position in the panel's plane of rotation (deg, East < 0)
+    bool sunUp;
+};
+
+typedef std::vector<double> DayTrace; // Transmittance per minute of day
+
+struct Day {
+    DayTrace trace;
+    int westFaultMinute; // Minute of day the West LDR goes open circuit, -1 = healthy
+};
+
+static unsigned long strokeMs = 30000;   // Full actuator travel time
+static double cycleWeightWh = 0.5;       // Score cost of one actuator pulse
+static double wrongWeightWh = 20.0;      // Score cost of one hour in the wrong state
+static double westGain = 1.0;            // West LDR mismatch: reads gain * true + offset
+static double westOffset = 0.0;
+
+// --- LIGHT TRACES ---
+
+DayTrace constantTrace(double t) {
+    return DayTrace(1440, t);
+}
+
+// Markov cloud field: clear spells and cloud banks with ~10 minute dwell
+DayTrace brokenCloudTrace(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    DayTrace trace(1440);
+    bool cloudy = false;
+    double depth = 0.3;
+    for (int i = 0; i < 1440; i++) {
+        if (u(rng) < 0.1) {
+            cloudy = !cloudy;
+            depth = 0.15 + 0.3 * u(rng);
+        }
+        trace[i] = cloudy ? depth : 0.95 + 0.05 * u(rng);
+    }
+    return trace;
+}
+
+bool loadTrace(const char* path, DayTrace& trace) {
+    std::ifstream in(path);
+    if (!in) return false;
+    trace.assign(1440, -1.0);
+    std::string line;
+    while (std::getline(in, line)) {
+        int hh, mm;
+        double t;
+        if (sscanf(line.c_str(), "%d:%d,%lf", &hh, &mm, &t) != 3) continue; // Header/comments
+        if (hh < 0 || hh > 23 || mm < 0 || mm > 59) continue;
+        trace[hh * 60 + mm] = std::min(1.0, std::max(0.0, t));
+    }
+    double last = 1.0;
+    for (double& t : trace) {
+        if (t < 0) t = last;
+        last = t;
+    }
+    return true;
+}
+
+Sky skyAt(double secOfDay, double transmittance) {
+    Sky sky;
+    sky.sunUp = secOfDay > SUNRISE_S && secOfDay < SUNSET_S;
+    double frac = (secOfDay - SUNRISE_S) / (SUNSET_S - SUNRISE_S);
+    sky.angle = -90.0 + 180.0 * std::min(1.0, std::max(0.0, frac));
+    double clear = 0.0;
+    if (sky.sunUp) {
+        clear = PEAK_IRRADIANCE * std::sin(PI_D * frac);
+    } else {
+        // Twilight glow decays away from sunrise/sunset
+        double away = std::min(std::fabs(secOfDay - SUNRISE_S), std::fabs(secOfDay - SUNSET_S));
+        away = std::min(away, std::fabs(secOfDay + 86400.0 - SUNRISE_S));
+        clear = 15.0 * std::exp(-away / (TWILIGHT_S / 3.0));
+    }
+    sky.direct = sky.sunUp ? clear * transmittance : 0.0;
+    sky.diffuse = clear * (0.1 + 0.3 * (1.0 - transmittance)) + (sky.sunUp ? 0.0 : clear);
+    return sky;
+}
+
+double panelAngle(double position) {
+    // Fully retracted (home, position 0) faces East
+    return -PANEL_RANGE_DEG + 2.0 * PANEL_RANGE_DEG * position / strokeMs;
+}
+
+double incidence(const Sky& sky, double normalDeg) {
+    return std::max(0.0, std::cos((sky.angle - normalDeg) * PI_D / 180.0));
+}
+
+int ldrCounts(double wm2) {
+    return (int)(1023.0 * wm2 / (wm2 + LDR_KNEE));
+}
+
+int westCounts(int counts) {
+    if (counts <= 0) return 0; // Dark stays dark
+    double v = westGain * counts + westOffset;
+    return (int)std::min(1023.0, std::max(0.0, v));
+}
+
+bool stateAcceptable(State s, const Sky& sky, bool faulted) {
+    if (s == STATE_ERROR) return false;
+    if (faulted) return s == STATE_REDUNDANT || s == STATE_NIGHT_RESET; // Night by the clock
+    if (s == STATE_REDUNDANT) return false; // Sensors are healthy
+    if (!sky.sunUp) return s == STATE_NIGHT_RESET;
+    if (sky.direct + sky.diffuse < DAYLIGHT_MIN) return true;
+    return s == STATE_IDLE || s == STATE_TRACKING;
+}
+
+// --- ONE SIMULATION RUN (uses only this thread's globals) ---
+
+void resetSimulation(const Params& p) {
+    for (int i = 0; i < 20; i++) {
+        mock_digitalRead_vals[i] = LOW;
+        mock_digitalWrite_vals[i] = LOW;
+        mock_analogRead_vals[i] = 0;
+        mock_pinMode_vals[i] = 0;
+        mock_analogWrite_vals[i] = 0;
+        mock_pinHighSince[i] = 0;
+        mock_pinHighMillis[i] = 0;
+        mock_pinRiseCount[i] = 0;
+    }
+    mock_millis_val = 0;
+    mock_eeprom_erase();
+    SD.format();
+
+    currentState = STATE_IDLE;
+    nightModeInitialized = false;
+    nightEntryTime = 0;
+    ledStartTime = 0;
+    ledOn = false;
+    lastTrackTime = 0;
+    lastTrackRtc = 0;
+    actuatorPosition = 0;
+    positionResidue = 0;
+    motorDirection = 0;
+    motorStartTime = 0;
+    motorDuty = 0;
+    currentSeen = false;
+    tripPending = false;
+    checkpointSlot = -1;
+    checkpointMillis = 0;
+    retractPending = false;
+    ldrCal.gain[0] = ldrCal.gain[1] = CAL_ONE;
+    ldrCal.offset[0] = ldrCal.offset[1] = 0;
+    calibrationSamples = -1;
+    mock_serial_input.clear();
+
+    TRACKING_INTERVAL = p.trackingInterval;
+    LDR_THRESHOLD = p.ldrThreshold;
+    REDUNDANT_MOVE_TIME = p.redundantMoveTime;
+    LDR_DARK_THRESHOLD = p.darkThreshold;
+    LDR_WAKE_THRESHOLD = p.wakeThreshold;
+}
+
+// Serial 'c' with both sensors under the same light, swept like a passing cloud
+void calibrateSensors() {
+    mock_serial_input = "c";
+    for (int i = 0; i <= CAL_SAMPLES; i++) {
+        int counts = ldrCounts(150.0 + 700.0 * i / CAL_SAMPLES);
+        mock_analogRead_vals[LDR_EAST] = counts;
+        mock_analogRead_vals[LDR_WEST] = westCounts(counts);
+        loop();
+    }
+}
+
+Result simulate(const Params& p, const std::vector<Day>& days, bool calibrate) {
+    const uint32_t start = DateTime(2023, 6, 1, 12, 0, 0).unixtime();
+    const double startOfDay = 12.0 * 3600;
+    const double duration = days.size() * 86400.0;
+
+    resetSimulation(p);
+    // True panel position comes from the actuator model (ideal kinematics)
+    ActuatorModel& act = mock_actuator_attach();
+    act.dynamic = false;
+    act.travel = strokeMs;
+    act.position = strokeMs / 2.0;
+    mock_now_val = DateTime(start);
+    setup();
+    if (calibrate) calibrateSensors();
+
+    Result r = { p, 0.0, 0, 0.0, 0.0, 0.0, 0.0 };
+    const unsigned long t0 = mock_millis_val;
+
+    while ((mock_millis_val - t0) / 1000.0 < duration) {
+        double elapsed = (mock_millis_val - t0) / 1000.0;
+        double t = startOfDay + elapsed;
+        size_t day = (size_t)(t / 86400.0) % days.size();
+        double secOfDay = std::fmod(t, 86400.0);
+        int minute = (int)(secOfDay / 60.0);
+        Sky sky = skyAt(secOfDay, days[day].trace[minute]);
+        bool faulted = days[day].westFaultMinute >= 0 && minute >= days[day].westFaultMinute;
+
+        double normal = panelAngle(act.position);
+        mock_analogRead_vals[LDR_EAST] = ldrCounts(sky.diffuse + sky.direct * incidence(sky, normal + LDR_TILT_DEG));
+        mock_analogRead_vals[LDR_WEST] = faulted ? 0 : westCounts(ldrCounts(sky.diffuse + sky.direct * incidence(sky, normal - LDR_TILT_DEG)));
+        mock_now_val = DateTime(start + (uint32_t)elapsed);
+
+        unsigned long before = mock_millis_val;
+        loop();
+        double dt = (mock_millis_val - before) / 1000.0;
+
+        r.energyWh += (sky.diffuse + sky.direct * incidence(sky, normal)) * dt / 3600.0;
+        if (!stateAcceptable(currentState, sky, faulted)) r.wrongHours += dt / 3600.0;
+        if (!faulted && sky.direct > 200.0 && std::fabs(sky.angle) < PANEL_RANGE_DEG) {
+            r.maxTrackErrorDeg = std::max(r.maxTrackErrorDeg, std::fabs(sky.angle - normal));
+        }
+    }
+
+    r.cycles = act.starts;
+    r.pulsesPerDay = (double)r.cycles / days.size();
+    mock_actuator_detach();
+    r.score = r.energyWh - cycleWeightWh * r.cycles - wrongWeightWh * r.wrongHours;
+    return r;
+}
+
+// The firmware on a clear day with matched sensors must follow the sun; if it
+// runs to an end stop instead, the sensor geometry no longer matches main.cpp
+bool checkPlant(const Params& firmware) {
+    double gain = westGain, offset = westOffset;
+    westGain = 1.0;
+    westOffset = 0.0;
+    Result r = simulate(firmware, std::vector<Day>(1, Day{ constantTrace(1.0), -1 }), false);
+    westGain = gain;
+    westOffset = offset;
+    if (r.maxTrackErrorDeg > MAX_TRACK_ERROR_DEG) {
+        std::cerr << "Plant check failed: firmware leaves the panel " << r.maxTrackErrorDeg
+                  << " deg off the sun on a clear day (limit " << MAX_TRACK_ERROR_DEG << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- THREAD POOL ---
+
+// Fixed pool of workers pulling job indices from a shared counter
+void runParallel(size_t jobs, unsigned threads, void (*job)(size_t, void*), void* ctx) {
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; i++) {
+        pool.emplace_back([&]() {
+            for (size_t j = next++; j < jobs; j = next++) job(j, ctx);
+        });
+    }
+    for (std::thread& t : pool) t.join();
+}
+
+struct Sweep {
+    const std::vector<Params>* params;
+    const std::vector<Day>* days;
+    bool calibrate;
+    std::vector<Result>* results;
+};
+
+void sweepJob(size_t i, void* ctx) {
+    Sweep* s = static_cast<Sweep*>(ctx);
+    (*s->results)[i] = simulate((*s->params)[i], *s->days, s->calibrate);
+}
+
+// --- PARAMETER SETS ---
+
+std::vector<Params> gridParams(bool sweepRedundant) {
+    const unsigned long intervals[] = { 300000, 600000, 1200000 };
+    const int thresholds[] = { 20, 50, 100 };
+    std::vector<unsigned long> redundant = { REDUNDANT_MOVE_TIME };
+    if (sweepRedundant) redundant = { 250, 500, 1000, 2000 };
+    const int darks[] = { 4, 8, 16 };
+    const int wakes[] = { 100, 150, 250 };
+    std::vector<Params> v;
+    for (unsigned long ti : intervals)
+        for (int th : thresholds)
+            for (unsigned long rm : redundant)
+                for (int dk : darks)
+                    for (int wk : wakes)
+                        v.push_back({ ti, th, rm, dk, wk });
+    return v;
+}
+
+std::vector<Params> randomParams(size_t n, unsigned seed, bool sweepRedundant) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<unsigned long> interval(60, 1800);
+    std::uniform_int_distribution<int> threshold(10, 150);
+    std::uniform_int_distribution<unsigned long> redundant(200, 3000);
+    std::uniform_int_distribution<int> dark(2, 30);
+    std::uniform_int_distribution<int> wake(50, 400);
+    std::vector<Params> v;
+    for (size_t i = 0; i < n; i++) {
+        unsigned long ti = interval(rng) * 1000;
+        int th = threshold(rng);
+        unsigned long rm = redundant(rng);
+        if (!sweepRedundant) rm = REDUNDANT_MOVE_TIME;
+        v.push_back({ ti, th, rm, dark(rng), wake(rng) });
+    }
+    return v;
+}
+
+void printResult(const char* rank, const Result& r) {
+    printf("%-6s %8lu %6d %8lu %5d %5d %11.1f %7lu %8.1f %8.2f %10.1f\n",
+           rank, r.params.trackingInterval / 1000, r.params.ldrThreshold,
+           r.params.redundantMoveTime, r.params.darkThreshold, r.params.wakeThreshold,
+           r.energyWh, r.cycles, r.pulsesPerDay, r.wrongHours, r.score);
+}
+
+int main(int argc, char** argv) {
+    size_t randomCount = 0;
+    unsigned seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t top = 10;
+    std::vector<Day> days;
+    bool calibrate = false;
+    bool mismatch = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--random" && hasValue) randomCount = strtoul(argv[++i], NULL, 10);
+        else if (arg == "--seed" && hasValue) seed = strtoul(argv[++i], NULL, 10);
+        else if (arg == "--threads" && hasValue) threads = std::max(1ul, strtoul(argv[++i], NULL, 10));
+        else if (arg == "--top" && hasValue) top = strtoul(argv[++i], NULL, 10);
+        else if (arg == "--stroke" && hasValue) strokeMs = std::max(1ul, strtoul(argv[++i], NULL, 10));
+        else if (arg == "--cycle-cost" && hasValue) cycleWeightWh = atof(argv[++i]);
+        else if (arg == "--wrong-cost" && hasValue) wrongWeightWh = atof(argv[++i]);
+        else if (arg == "--calibrate") calibrate = true;
+        else if (arg == "--mismatch" && hasValue &&
+                 sscanf(argv[++i], "%lf,%lf", &westGain, &westOffset) == 2) mismatch = true;
+        else if (arg == "--trace" && hasValue) {
+            DayTrace trace;
+            if (!loadTrace(argv[++i], trace)) {
+                std::cerr << "Cannot read trace " << argv[i] << std::endl;
+                return 1;
+            }
+            days.push_back({ trace, -1 });
+        } else if (arg == "--fault" && hasValue) {
+            int hh, mm;
+            if (sscanf(argv[++i], "%d:%d", &hh, &mm) != 2 || hh < 0 || hh > 23 || mm < 0 || mm > 59) {
+                std::cerr << "Bad fault time " << argv[i] << " (HH:MM)" << std::endl;
+                return 1;
+            }
+            days.push_back({ constantTrace(1.0), hh * 60 + mm });
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--random N] [--seed S] [--threads T] [--top K] [--stroke MS]"
+                      << " [--cycle-cost WH] [--wrong-cost WH] [--mismatch GAIN,OFFSET] [--calibrate]"
+                      << " [--trace FILE]... [--fault HH:MM]..."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    bool traces = false, sweepRedundant = false;
+    for (const Day& d : days) {
+        if (d.westFaultMinute < 0) traces = true;
+        else sweepRedundant = true;
+    }
+    if (!traces) {
+        days.push_back({ constantTrace(1.0), -1 });      // Clear day
+        days.push_back({ brokenCloudTrace(seed), -1 });  // Sunny spells and showers
+        days.push_back({ constantTrace(0.15), -1 });     // Overcast
+        if (!sweepRedundant) days.push_back({ constantTrace(1.0), 9 * 60 }); // West LDR wire breaks
+        sweepRedundant = true;
+    }
+
+    const Params firmware = { TRACKING_INTERVAL, LDR_THRESHOLD, REDUNDANT_MOVE_TIME,
+                              LDR_DARK_THRESHOLD, LDR_WAKE_THRESHOLD };
+    if (!checkPlant(firmware)) return 1;
+
+    std::vector<Params> params = randomCount ? randomParams(randomCount, seed, sweepRedundant)
+                                             : gridParams(sweepRedundant);
+    params.push_back(firmware);
+
+    std::cout << "Simulating " << params.size() << " parameter sets over " << days.size()
+              << " day(s) on " << threads << " thread(s)..." << std::endl;
+
+    std::vector<Result> results(params.size());
+    Sweep sweep = { &params, &days, calibrate, &results };
+    runParallel(params.size(), threads, sweepJob, &sweep);
+
+    Result baseline = results.back();
+    std::sort(results.begin(), results.end(),
+              [](const Result& a, const Result& b) { return a.score > b.score; });
+
+    printf("%-6s %8s %6s %8s %5s %5s %11s %7s %8s %8s %10s\n",
+           "Rank", "Intv(s)", "Thresh", "RedMove", "Dark", "Wake",
+           "Energy(Wh)", "Cycles", "Pulse/d", "Wrong(h)", "Score");
+    for (size_t i = 0; i < std::min(top, results.size()); i++) {
+        char rank[24];
+        snprintf(rank, sizeof(rank), "%zu", i + 1);
+        printResult(rank, results[i]);
+    }
+    printResult(calibrate ? "fw+cal" : "fw", baseline);
+    if (mismatch) {
+        // Same firmware, other calibration setting
+        printResult(calibrate ? "fw" : "fw+cal", simulate(firmware, days, !calibrate));
+    }
+    return 0;
+}